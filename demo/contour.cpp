@@ -0,0 +1,27 @@
+#include <cmath>
+#include "matplotlib.hpp"
+
+int main()
+{
+    auto plt   = matplotlibcpp::PLT();
+    long n     = 2000;
+    std::vector<double> x(n), y(n), z(n * n);
+    for (long i = 0; i < n; ++i) {
+        x[i] = -3.0 + 6.0 * i / (n - 1);
+        y[i] = -2.0 + 4.0 * i / (n - 1);
+    }
+    for (long i = 0; i < n; ++i) {
+        for (long j = 0; j < n; ++j) {
+            z[i * n + j] = (1 - x[j] / 2 + std::pow(x[j], 5) + std::pow(y[i], 3)) * std::exp(-x[j] * x[j] - y[i] * y[i]);
+        }
+    }
+
+    auto ax    = plt.subplots().second;
+    auto bands = ax.contour(x, y, z.data(), 12L, matplotlibcpp::ContourOptions(true), {{"cmap", "RdBu_r"}});
+    auto lines = ax.contour(x, y, z.data(), 12L, matplotlibcpp::ContourOptions(), {{"colors", "k"}});
+    plt.colorbar(bands);
+    plt.clabel(lines, 8);
+
+    plt.savefig("contour.png");
+    plt.show();
+}
@@ -0,0 +1,266 @@
+// Checks the numeric kernels against matplotlib, numpy or exact results: quantiles,
+// box and violin statistics, the P-square estimator, Douglas-Peucker, colormap binning
+// and the contour generator. Prints the failed checks and returns nonzero if any.
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include "matplotlib.hpp"
+
+using namespace matplotlibcpp;
+
+static int failures = 0;
+
+static void check(bool ok, const char* what)
+{
+    failures += !ok;
+    std::printf("%-60s %s\n", what, ok ? "ok" : "FAILED");
+}
+
+// The floats of a python expression evaluated with numpy as np, data bound to values.
+static std::vector<double> evaluate(const std::string& expression, const std::vector<double>& values)
+{
+    detail::NewRef globals = PyDict_New();
+    detail::NewRef numpy   = PyImport_ImportModule("numpy");
+    detail::NewRef cbook   = PyImport_ImportModule("matplotlib.cbook");
+    detail::NewRef mpl     = PyImport_ImportModule("matplotlib");
+    PyDict_SetItemString(globals, "__builtins__", PyEval_GetBuiltins());
+    PyDict_SetItemString(globals, "np", numpy);
+    PyDict_SetItemString(globals, "cbook", cbook);
+    PyDict_SetItemString(globals, "mpl", mpl);
+    PyDict_SetItemString(globals, "data", detail::get_pyarray(values));
+    detail::NewRef result = PyRun_String(("[float(v) for v in np.ravel(" + expression + ")]").c_str(), Py_eval_input,
+                                         globals, globals);
+    if (!result) {
+        PyErr_Print();
+        throw std::runtime_error("Couldn't evaluate " + expression);
+    }
+    std::vector<double> out;
+    for (Py_ssize_t i = 0; i < PyList_Size(result); ++i) {
+        out.push_back(PyFloat_AsDouble(PyList_GetItem(result, i)));
+    }
+    return out;
+}
+
+static bool close(double a, double b, double tolerance)
+{
+    return std::fabs(a - b) <= tolerance * std::max(1.0, std::fabs(b));
+}
+
+static void check_stats(const std::vector<double>& data)
+{
+    std::vector<double> ps{0.0, 0.05, 0.25, 0.5, 0.75, 0.95, 1.0};
+    auto values    = data;
+    auto quantiles = detail::get_quantiles(values, ps);
+    auto expected  = evaluate("np.percentile(data, [0, 5, 25, 50, 75, 95, 100])", data);
+    bool ok        = true;
+    for (std::size_t k = 0; k < ps.size(); ++k) {
+        ok = ok && close(quantiles[k], expected[k], 1e-12);
+    }
+    check(ok, "get_quantiles matches numpy.percentile");
+
+    const char* keys = "'mean', 'med', 'q1', 'q3', 'iqr', 'cilo', 'cihi', 'whislo', 'whishi'";
+    std::vector<std::pair<std::vector<double>, std::string>> cases{{{1.5}, "1.5"}, {{5, 95}, "(5, 95)"}};
+    for (const auto& c : cases) {
+        auto stats = detail::get_box_stats(data, c.first);
+        std::string expression =
+            "[s[k] for s in cbook.boxplot_stats(data, whis=" + c.second + ") for k in (" + keys + ")] + " +
+            "[len(cbook.boxplot_stats(data, whis=" + c.second + ")[0]['fliers'])]";
+        expected = evaluate(expression, data);
+        double got[] = {stats.mean, stats.med,  stats.q1,     stats.q3,     stats.iqr,
+                        stats.cilo, stats.cihi, stats.whislo, stats.whishi, double(stats.fliers.size())};
+        ok = true;
+        for (std::size_t k = 0; k < expected.size(); ++k) {
+            ok = ok && close(got[k], expected[k], 1e-12);
+        }
+        check(ok, ("get_box_stats matches cbook.boxplot_stats, whis=" + c.second).c_str());
+    }
+
+    // the binned KDE against the exact sum over the samples
+    auto violin = detail::get_violin_stats(data, 50);
+    double n = double(data.size()), sum = 0, sum2 = 0, peak = 0, error = 0;
+    for (double value : data) {
+        sum += value;
+    }
+    for (double value : data) {
+        sum2 += (value - sum / n) * (value - sum / n);
+    }
+    double bandwidth = std::pow(n, -0.2) * std::sqrt(sum2 / (n - 1));
+    for (std::size_t k = 0; k < violin.coords.size(); ++k) {
+        double density = 0;
+        for (double value : data) {
+            double u = (violin.coords[k] - value) / bandwidth;
+            density += std::exp(-0.5 * u * u);
+        }
+        density /= n * bandwidth * std::sqrt(2 * M_PI);
+        peak  = std::max(peak, density);
+        error = std::max(error, std::fabs(density - violin.vals[k]));
+    }
+    check(error < 1e-3 * peak, "get_violin_stats matches the exact gaussian KDE");
+    check(violin.median == evaluate("np.median(data)", data)[0], "get_violin_stats median matches numpy.median");
+}
+
+static void check_p2(const std::vector<double>& data)
+{
+    bool ok = true;
+    for (double p : {0.1, 0.5, 0.9}) {
+        detail::P2Quantile estimator(p);
+        for (double value : data) {
+            estimator.add(value);
+        }
+        auto values = data;
+        ok          = ok && std::fabs(estimator.value() - detail::get_quantiles(values, {p})[0]) < 0.02;
+    }
+    check(ok, "P2Quantile is within 0.02 of the exact quantiles");
+
+    detail::P2Quantile few(0.5);
+    for (double value : {3.0, 1.0, 2.0}) {
+        few.add(value);
+    }
+    check(few.value() == 2.0, "P2Quantile is exact below five samples");
+}
+
+// Distance of the point k to the kept polyline, between the kept points around it.
+static double get_deviation(const std::vector<double>& xy, const std::vector<std::size_t>& kept, std::size_t k)
+{
+    auto b = std::upper_bound(kept.begin(), kept.end(), k);
+    return detail::get_segment_distance(&xy[2 * k], &xy[2 * *(b - 1)], &xy[2 * *b]);
+}
+
+static void check_simplify()
+{
+    std::vector<double> line;
+    std::vector<std::size_t> indices;
+    for (std::size_t k = 0; k < 100; ++k) {
+        line.push_back(double(k));
+        line.push_back(2.0 * k);
+        indices.push_back(k);
+    }
+    std::vector<std::size_t> kept;
+    detail::simplify_polyline(line.data(), indices, 0.5, kept);
+    check(kept == std::vector<std::size_t>({0, 99}), "simplify_polyline keeps the ends of a straight line");
+
+    std::mt19937 gen(7);
+    std::normal_distribution<double> normal;
+    std::vector<double> walk{0.0, 0.0};
+    for (std::size_t k = 1; k < 5000; ++k) {
+        walk.push_back(walk[2 * k - 2] + std::fabs(normal(gen)));
+        walk.push_back(walk[2 * k - 1] + normal(gen));
+    }
+    indices.resize(5000);
+    for (std::size_t k = 0; k < indices.size(); ++k) {
+        indices[k] = k;
+    }
+    kept.clear();
+    detail::simplify_polyline(walk.data(), indices, 2.0, kept);
+    bool ok = kept.front() == 0 && kept.back() == 4999 && kept.size() < indices.size();
+    for (std::size_t k = 0; k < indices.size() && ok; ++k) {
+        ok = std::binary_search(kept.begin(), kept.end(), k) || get_deviation(walk, kept, k) <= 2.0;
+    }
+    check(ok, "simplify_polyline stays within the tolerance");
+
+    walk[2 * 100] = NAN;
+    auto simplified = detail::get_simplified(walk.data(), 5000, 1.0, 0.5);
+    check(std::binary_search(simplified.begin(), simplified.end(), std::size_t(100)) && simplified.front() == 0 &&
+              simplified.back() == 4999,
+          "get_simplified keeps the ends and the gaps");
+}
+
+static void check_colormap(const std::vector<double>& data)
+{
+    for (bool log : {false, true}) {
+        std::vector<double> values = data;
+        values.insert(values.end(), {-1.0, 0.0, 1e-3, 1.0, 1.0 + 1e-9, 1e3, NAN, INFINITY, -INFINITY});
+        ColorMap colormap("viridis", 0.01, 1.0, log, 1);
+        std::vector<std::uint8_t> rgba(4 * values.size());
+        colormap.apply(values.data(), 1, long(values.size()), rgba.data());
+        auto expected = evaluate(std::string("mpl.colormaps['viridis'](mpl.colors.") +
+                                     (log ? "LogNorm" : "Normalize") + "(0.01, 1.0)(data), bytes=True)",
+                                 values);
+        // single precision may move a value on a bin edge to the neighboring color, a few units away
+        long moved = 0;
+        bool ok    = expected.size() == rgba.size();
+        for (std::size_t k = 0; k < rgba.size() && ok; ++k) {
+            moved += std::fabs(rgba[k] - expected[k]) > 0;
+            ok = std::fabs(rgba[k] - expected[k]) <= 4;
+        }
+        check(ok && moved <= long(values.size() / 1000),
+              log ? "ColorMap matches LogNorm and the colormap" : "ColorMap matches Normalize and the colormap");
+    }
+}
+
+static void check_contour()
+{
+    // the plane z = x on [0, 1] x [0, 1]
+    long n = 11;
+    std::vector<double> x(n), y(n), z(n * n);
+    for (long i = 0; i < n; ++i) {
+        x[i] = y[i] = double(i) / (n - 1);
+    }
+    for (long i = 0; i < n; ++i) {
+        for (long j = 0; j < n; ++j) {
+            z[i * n + j] = x[j];
+        }
+    }
+    detail::ContourGenerator<double, double, double> generator(x.data(), y.data(), z.data(), n, n, 2);
+
+    auto lines = generator.lines({0.55});
+    double ymin = 1, ymax = 0;
+    bool ok     = !lines[0].codes.empty();
+    for (std::size_t k = 0; k < lines[0].codes.size(); ++k) {
+        ok   = ok && std::fabs(lines[0].vertices[2 * k] - 0.55) < 1e-12;
+        ymin = std::min(ymin, lines[0].vertices[2 * k + 1]);
+        ymax = std::max(ymax, lines[0].vertices[2 * k + 1]);
+    }
+    check(ok && ymin == 0 && ymax == 1, "contour lines of a plane are straight");
+
+    // the areas of the bands, summed over the polygons of each path
+    auto bands = generator.bands({0.0, 0.25, 0.75, 1.0});
+    ok         = bands.size() == 3;
+    double expected[] = {0.25, 0.5, 0.25};
+    for (std::size_t b = 0; b < bands.size() && ok; ++b) {
+        const auto& path = bands[b];
+        double area = 0, polygon = 0;
+        std::size_t start = 0;
+        for (std::size_t k = 0; k <= path.codes.size(); ++k) {
+            if (k == path.codes.size() || path.codes[k] == detail::ContourPath::MOVETO) {
+                area += std::fabs(polygon) / 2;
+                polygon = 0;
+                start   = k;
+            }
+            if (k == path.codes.size() || path.codes[k] == detail::ContourPath::CLOSEPOLY) {
+                continue;
+            }
+            const double* p = &path.vertices[2 * k];
+            const double* q = k + 1 < path.codes.size() && path.codes[k + 1] == detail::ContourPath::LINETO
+                                  ? &path.vertices[2 * k + 2]
+                                  : &path.vertices[2 * start];
+            polygon += p[0] * q[1] - q[0] * p[1];
+        }
+        ok = close(area, expected[b], 1e-9);
+    }
+    check(ok, "filled contour bands of a plane have the exact areas");
+}
+
+int main()
+{
+    auto plt = PLT("Agg");
+    std::mt19937 gen(42);
+    std::normal_distribution<double> normal;
+    std::vector<double> data(20000);
+    for (auto& value : data) {
+        value = normal(gen);
+    }
+    data[0] = 8.0;
+
+    check_stats(data);
+    check_p2(data);
+    check_simplify();
+    std::uniform_real_distribution<double> uniform(-0.1, 1.1);
+    for (auto& value : data) {
+        value = uniform(gen);
+    }
+    check_colormap(data);
+    check_contour();
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
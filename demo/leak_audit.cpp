@@ -0,0 +1,287 @@
+// Calls every API in a loop and checks that the interpreter's allocated blocks
+// and gc-tracked objects stay flat, i.e. that no reference is leaked: the growth
+// over 2n calls may exceed the growth over n calls by a few blocks only.
+// usage: leak_audit [n], n is at least 128
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include "matplotlib.hpp"
+
+using matplotlibcpp::detail::get_allocation_count;
+
+struct Audit
+{
+    const char* name;
+    long iterations;
+    std::function<void()> call;
+};
+
+int main(int argc, char** argv)
+{
+    // allowed growth of the second run over the first, independent of the number of calls. The gc
+    // counts objects exactly, allocated blocks move by a few dozens with the free lists and caches,
+    // so n stays above the block slack and a leak of one block per call is still seen.
+    const long object_slack = 8, block_slack = 64;
+    long iterations         = std::max(argc > 1 ? std::atol(argv[1]) : 0, 2 * block_slack);
+    auto plt                = matplotlibcpp::PLT("Agg");
+
+    std::vector<double> x{1, 2, 3, 4}, y{4, 1, 3, 2};
+    std::vector<std::vector<double>> xx{x, y};
+    std::vector<float> field(64 * 64, 1.0f);
+    std::vector<std::uint8_t> rgba(4 * 64 * 64);
+    std::vector<double> grid(64);
+    for (int i = 0; i < 64; ++i) {
+        grid[i]                = i;
+        field[i * 64 + i % 32] = float(i % 7);
+    }
+    matplotlibcpp::detail::Image image;
+
+    std::vector<Audit> audits{
+        {"PyContainer", 100 * iterations,
+         [&]() {
+             matplotlibcpp::detail::PyContainer args;
+             args << 1.0 << 2L << 3 << true << false << std::string("s") << x << xx;
+             auto tuple = args.to_tuple();
+             auto list  = args.to_list();
+         }},
+        {"get_keywords", 100 * iterations,
+         [&]() { auto kwargs = matplotlibcpp::detail::get_keywords({{"color", "red"}, {"label", "x"}}); }},
+        {"get_pyarray", 100 * iterations,
+         [&]() {
+             auto copy = matplotlibcpp::detail::get_pyarray(x);
+             auto view = matplotlibcpp::detail::get_pyarray_view(field.data(), {64, 64});
+         }},
+        {"plot", iterations,
+         [&]() {
+             plt.plot(x, y, "--o", {{"label", "a"}});
+             plt.cla();
+         }},
+        {"scatter", iterations,
+         [&]() {
+             plt.scatter(x, y, 2.0);
+             plt.cla();
+         }},
+        {"hist", iterations,
+         [&]() {
+             plt.hist(y, 4);
+             plt.cla();
+         }},
+        {"bar", iterations,
+         [&]() {
+             plt.bar(x, y);
+             plt.cla();
+         }},
+        {"fill_between", iterations,
+         [&]() {
+             plt.fill_between(x, x, y, {{"alpha", "0.5"}});
+             plt.cla();
+         }},
+        {"errorbar", iterations,
+         [&]() {
+             plt.errorbar(x, y, x);
+             plt.cla();
+         }},
+        {"text/annotate", iterations,
+         [&]() {
+             plt.text(1, 1, "text");
+             plt.annotate("annotation", 2, 2);
+             plt.cla();
+         }},
+        {"xticks/limits", iterations,
+         [&]() {
+             plt.xticks(x, {"a", "b", "c", "d"});
+             plt.xlim(0, 5);
+             (void)plt.ylim();
+             plt.cla();
+         }},
+        {"imshow/set_data", iterations,
+         [&]() {
+             image = plt.imshow(field.data(), 64, 64, 0.0, 2.0);
+             image.set_data(field.data());
+             image = matplotlibcpp::detail::Image();
+             plt.cla();
+         }},
+        {"plot_many", iterations,
+         [&]() {
+             plt.plot_many(x, y.data(), 1, {{1.0}, {}, {2.0}});
+             plt.cla();
+         }},
+        {"contour/clabel", iterations,
+         [&]() {
+             auto bands = plt.contour(grid, grid, field.data(), 5L, matplotlibcpp::ContourOptions(true));
+             auto lines = plt.contour(grid, grid, field.data(), 5L, matplotlibcpp::ContourOptions());
+             plt.clabel(lines);
+             plt.cla();
+         }},
+        {"quiver", iterations,
+         [&]() {
+             plt.quiver(grid, grid, field.data(), field.data(), matplotlibcpp::QuiverOptions(16, true, true));
+             plt.quiver(x, y, y, x);
+             plt.cla();
+         }},
+        {"boxplot/violinplot", iterations,
+         [&]() {
+             plt.boxplot(xx, {"a", "b"}, {{"notch", "True"}});
+             plt.violinplot(xx, {"a", "b"});
+             plt.cla();
+         }},
+        {"band/fill_between", iterations,
+         [&]() {
+             plt.band(x, y, matplotlibcpp::BandOptions(2));
+             plt.fill_between(x, y, x, 0.5);
+             plt.cla();
+         }},
+        {"spy (sparse)", iterations,
+         [&]() {
+             long indptr[] = {0, 2, 3}, indices[] = {0, 3, 1};
+             plt.spy(matplotlibcpp::CsrMatrix<long>(indptr, indices, 2, 4));
+             plt.spy(matplotlibcpp::CsrMatrix<long>(indptr, indices, 2, 4), matplotlibcpp::SpyOptions(true));
+             plt.cla();
+         }},
+        {"texts", iterations,
+         [&]() {
+             std::vector<std::string> labels{"a", "b", "c", "d"};
+             plt.texts(x, y, labels, {{}, {}, {8, 9, 10, 11}}, matplotlibcpp::TextOptions(true));
+             plt.cla();
+         }},
+        {"render cache", iterations,
+         [&]() {
+             while (!plt.get_fignums().empty()) {
+                 plt.close();
+             }
+             plt.enable_render_cache("leak_audit_cache", 1 << 20);
+             plt.plot(x, y);
+             plt.savefig("leak_audit_cache.png");
+             plt.savefig("leak_audit_cache.png");
+             plt.close();
+             plt.disable_render_cache();
+         }},
+        {"vector export", iterations,
+         [&]() {
+             // the SVG backend itself keeps objects per savefig, PNG goes through the same steps
+             plt.plot(x, y);
+             plt.scatter(x, y);
+             plt.savefig("leak_audit.png", matplotlibcpp::VectorOptions(1, 0.5));
+             plt.cla();
+         }},
+        {"savefig_multi", iterations,
+         [&]() {
+             // one dpi, every new renderer adds entries to matplotlib's text metrics cache until it is full
+             std::vector<char> buffer;
+             plt.plot(x, y);
+             plt.savefig_multi({matplotlibcpp::SaveTarget("leak_audit.png"), matplotlibcpp::SaveTarget(buffer, "png"),
+                                matplotlibcpp::SaveTarget(buffer, "rgba")});
+             plt.cla();
+         }},
+        {"layout cache", iterations,
+         [&]() {
+             // a miss runs tight_layout, which fills matplotlib's text metrics cache on every new figure
+             if (!plt.layout_cache) {
+                 plt.enable_layout_cache();
+             }
+             auto axes = plt.subplots(1, 2).second;
+             axes[0].plot(x, y, "", {{"label", "a"}});
+             axes[0].set_title("title");
+             axes[0].legend();
+             plt.tight_layout();
+             plt.close();
+         }},
+        {"savefig_tiles", iterations,
+         [&]() {
+             // a single tile, tiles of other sizes get new renderers which fill matplotlib's text metrics cache
+             plt.plot(x, y);
+             plt.savefig_tiles("leak_audit_tiles", 20, matplotlibcpp::TileOptions(128, 1));
+             plt.cla();
+         }},
+        {"datetime64", iterations,
+         [&]() {
+             std::vector<std::chrono::system_clock::time_point> t(4);
+             std::vector<std::int64_t> ms{0, 1000, 2000, 3000};
+             plt.plot(t, y);
+             plt.scatter(matplotlibcpp::TimeStamps(ms, "ms"), y);
+             plt.fill_between(matplotlibcpp::TimeStamps(ms, "ms"), x, y);
+             plt.cla();
+         }},
+        {"categories", iterations,
+         [&]() {
+             std::vector<std::string> names{"a", "b", "a", "c"};
+             plt.bar(names, y);
+             plt.scatter(matplotlibcpp::Categories(names), y);
+             plt.xticks(x, names);
+             plt.cla();
+         }},
+        {"profiling", iterations,
+         [&]() {
+             plt.enable_profiling();
+             plt.plot(x, y);
+             plt.draw();
+             plt.profiler->get_hotspots(5);
+             plt.profiler->write_collapsed_stacks("leak_audit.folded");
+             plt.disable_profiling();
+             plt.cla();
+         }},
+        {"scatter arrays", iterations,
+         [&]() {
+             std::vector<std::array<std::uint8_t, 4>> rgba(x.size(), {{255, 0, 0, 128}});
+             plt.scatter(x, y, x);
+             plt.scatter(x, y, x, y, 0, 1, {{"cmap", "viridis"}});
+             plt.scatter(x, y, std::vector<double>{}, rgba);
+             plt.cla();
+         }},
+        {"colormap", iterations,
+         [&]() {
+             matplotlibcpp::ColorMap colormap("viridis", 0.0, 2.0);
+             colormap.apply(field.data(), 64, 64, rgba.data());
+             auto colored = plt.imshow(rgba.data(), 64, 64, 4);
+             colored.set_data(rgba.data());
+             colormap.set_clim(0.0, 1.0);
+             plt.colorbar(colormap);
+             plt.clf();
+         }},
+        {"ArrayHandle", iterations,
+         [&]() {
+             matplotlibcpp::ArrayHandle handle(matplotlibcpp::detail::get_pyarray(field.data(), {64, 64}));
+             matplotlibcpp::ArrayHandle column(matplotlibcpp::detail::get_pyarray_view(grid.data(), {64}));
+             plt.plot(column, column);
+             plt.scatter(column, column, 2.0);
+             auto view = plt.imshow(handle, 0.0, 2.0);
+             view.set_data(handle);
+             plt.cla();
+         }},
+        {"subplots/gca/twinx", iterations,
+         [&]() {
+             auto axes = plt.subplots(2, 2).second;
+             axes[3].plot(x, y);
+             auto ax  = plt.gca();
+             auto tax = ax.twinx();
+             plt.close();
+         }},
+    };
+
+    // growth of the allocated blocks and objects over n calls
+    auto growth = [](Audit& audit, long n) {
+        auto before = get_allocation_count();
+        for (long i = 0; i < n; ++i) {
+            audit.call();
+        }
+        auto after = get_allocation_count();
+        return std::make_pair(after.blocks - before.blocks, after.objects - before.objects);
+    };
+
+    int failures = 0;
+    for (auto& audit : audits) {
+        // let matplotlib fill its caches first
+        growth(audit, 100);
+        // the second run makes n more calls than the first: a leak of one block per call adds n blocks,
+        // caches and allocator noise add about the same to both runs
+        auto once   = growth(audit, audit.iterations);
+        auto twice  = growth(audit, 2 * audit.iterations);
+        long blocks = twice.first - once.first, objects = twice.second - once.second;
+        bool ok     = blocks <= block_slack && objects <= object_slack;
+        failures += !ok;
+        std::printf("%-20s %9ld calls  blocks %+7ld  objects %+7ld  %s\n", audit.name, audit.iterations, blocks, objects,
+                    ok ? "ok" : "LEAK");
+    }
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,43 @@
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include "matplotlib_client.hpp"
+
+// Plots through a running plot_server, usage: plot_client [socket path]
+
+int main(int argc, char** argv)
+{
+    auto start = std::chrono::steady_clock::now();
+    matplotlibcpp::PlotClient plt(argc > 1 ? argv[1] : matplotlibcpp::detail::get_socket_path());
+
+    // 1e5 samples per array, sent as memfds
+    long n = 100000;
+    std::vector<double> x(n), y(n), z(n);
+    for (long i = 0; i < n; ++i) {
+        x[i] = 10.0 * i / n;
+        y[i] = std::sin(x[i]);
+        z[i] = std::cos(x[i]);
+    }
+
+    plt.figure_size({8, 6});
+    plt.subplot(2, 1, 1);
+    plt.plot(x, y, "b-", {{"label", "sin"}});
+    plt.plot(x, z, "r--", {{"label", "cos"}});
+    plt.legend();
+    plt.grid(true);
+    plt.title("plot server");
+
+    std::vector<float> image(64 * 64);
+    for (long i = 0; i < 64 * 64; ++i) {
+        image[i] = float(std::sin(i % 64 / 8.0) * std::cos(i / 64 / 8.0));
+    }
+    plt.subplot(2, 1, 2);
+    auto mappable = plt.imshow(image.data(), 64, 64, {{"cmap", "viridis"}});
+    plt.colorbar(mappable);
+    plt.tight_layout();
+    plt.savefig("plot_client.png");
+
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "plot_client.png in " << elapsed << " ms" << std::endl;
+    return 0;
+}
@@ -0,0 +1,22 @@
+#include <csignal>
+#include "matplotlib_server.hpp"
+
+// Plot server for plot_client, usage: plot_server [socket path]
+// Stop it with Ctrl-C.
+
+static matplotlibcpp::PlotServer* server = nullptr;
+
+static void on_signal(int)
+{
+    server->stop();
+}
+
+int main(int argc, char** argv)
+{
+    matplotlibcpp::PlotServer plot_server(argc > 1 ? argv[1] : matplotlibcpp::detail::get_socket_path());
+    server = &plot_server;
+    std::signal(SIGINT, on_signal);
+    std::signal(SIGTERM, on_signal);
+    plot_server.run();
+    return 0;
+}
@@ -0,0 +1,22 @@
+#include <random>
+#include "matplotlib.hpp"
+
+int main()
+{
+    auto plt = matplotlibcpp::PLT();
+    std::mt19937 gen(42);
+    std::normal_distribution<double> normal;
+    std::size_t n = 10000000;
+    std::vector<double> x(n), y(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        x[i] = normal(gen);
+        y[i] = 0.5 * x[i] + 0.3 * normal(gen);
+    }
+
+    auto ax = plt.subplots().second;
+    ax.scatter(x, y, matplotlibcpp::RasterOptions(1.0, true, true), {{"cmap", "magma"}});
+    ax.set_title("10M points");
+
+    plt.savefig("raster.png");
+    plt.show();
+}
@@ -0,0 +1,63 @@
+// Compares the ways of plotting data from an application that embeds python with pybind11.
+// usage: benchmark_pybind11 [points] [repeats]
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <pybind11/stl.h>
+#include "matplotlib_pybind11.hpp"
+
+namespace py = pybind11;
+
+static void bench(const char* name, long repeats, const std::function<void()>& run)
+{
+    run();
+    auto start = std::chrono::steady_clock::now();
+    for (long k = 0; k < repeats; ++k) {
+        run();
+    }
+    auto stop = std::chrono::steady_clock::now();
+    double ms = std::chrono::duration<double, std::milli>(stop - start).count() / repeats;
+    std::printf("%-42s %10.3f ms\n", name, ms);
+}
+
+int main(int argc, char** argv)
+{
+    py::scoped_interpreter guard;
+    long n       = argc > 1 ? std::atol(argv[1]) : 1000000;
+    long repeats = argc > 2 ? std::atol(argv[2]) : 20;
+
+    std::vector<double> x(n), y(n);
+    for (long k = 0; k < n; ++k) {
+        x[k] = k * 1e-3;
+        y[k] = std::sin(x[k]);
+    }
+    // data the application already keeps in python
+    py::array_t<double> array_x(n, x.data()), array_y(n, y.data());
+
+    matplotlibcpp::PybindPLT plt("Agg");
+    auto pyplot = py::module_::import("matplotlib.pyplot");
+
+    bench("PLT, std::vector", repeats, [&]() {
+        plt.plot(x, y);
+        plt.cla();
+    });
+    bench("PLT, std::vector as a zero-copy view", repeats, [&]() {
+        plt.plot(matplotlibcpp::ArrayHandle(matplotlibcpp::detail::get_pyarray_view(x.data(), {n})),
+                 matplotlibcpp::ArrayHandle(matplotlibcpp::detail::get_pyarray_view(y.data(), {n})));
+        plt.cla();
+    });
+    bench("PybindPLT, py::array_t", repeats, [&]() {
+        plt.plot(array_x, array_y);
+        plt.cla();
+    });
+    bench("pybind11, std::vector through stl.h", repeats, [&]() {
+        pyplot.attr("plot")(x, y);
+        pyplot.attr("cla")();
+    });
+    bench("pybind11, py::array_t", repeats, [&]() {
+        pyplot.attr("plot")(array_x, array_y);
+        pyplot.attr("cla")();
+    });
+}
@@ -0,0 +1,130 @@
+#ifndef __PLT_ARTIST_HPP__
+#define __PLT_ARTIST_HPP__
+
+#include "utility.hpp"
+
+namespace matplotlibcpp
+{
+namespace detail
+{
+/** Handle of an artist returned by a plotting function.
+ * The handle owns a reference to the artist, copies share it.
+ */
+class Artist
+{
+public:
+    Artist() : artist(nullptr) {}
+
+    explicit Artist(PyObject* artist) : artist(artist)
+    {
+        if (!artist) {
+            throw std::runtime_error("artist is nullptr");
+        }
+        Py_INCREF(this->artist);
+    }
+
+    Artist(const Artist& other) : artist(other.artist)
+    {
+        Py_XINCREF(this->artist);
+    }
+
+    Artist& operator=(const Artist& other)
+    {
+        Py_XINCREF(other.artist);
+        Py_XDECREF(this->artist);
+        this->artist = other.artist;
+        return *this;
+    }
+
+    virtual ~Artist()
+    {
+        Py_XDECREF(this->artist);
+    }
+
+    void set(const KeyWords& keywords)
+    {
+        auto func = this->get_func("set");
+        func.call(nullptr, detail::get_keywords(keywords));
+    }
+
+    void remove()
+    {
+        auto func = this->get_func("remove");
+        func.call();
+    }
+
+    PyObject* get_artist() const
+    {
+        return this->artist;
+    }
+
+protected:
+    Load_func get_func(const std::string& name)
+    {
+        return Load_func(name, this->artist);
+    }
+
+    PyObject* artist;
+};
+
+/** Handle of an AxesImage (imshow, matshow) or a QuadMesh (pcolormesh). */
+class Image : public Artist
+{
+public:
+    Image() = default;
+
+    // setter is set_data for an AxesImage and set_array for a QuadMesh
+    Image(PyObject* image, const std::vector<npy_intp>& shape, const std::string& setter = "set_data")
+        : Artist(image), shape(shape), setter(setter)
+    {
+    }
+
+    /**
+     * @brief Swap in a new frame of the same shape.
+     *
+     * The buffer is wrapped without copying and has to stay valid until the figure is drawn.
+     * When the image was created with fixed vmin/vmax the norm is not recomputed.
+     */
+    template <typename Scalar>
+    void set_data(const Scalar* data)
+    {
+        detail::PyContainer args;
+        args << detail::get_pyarray_view(data, this->shape);
+        auto func = this->get_func(this->setter);
+        func.call(args.to_tuple());
+    }
+
+    template <typename Scalar>
+    void set_data(const Scalar* data, long rows, long cols, long channels = 1)
+    {
+        this->shape = {rows, cols};
+        if (channels > 1) {
+            this->shape.push_back(channels);
+        }
+        this->set_data(data);
+    }
+
+    void set_data(const ArrayHandle& data)
+    {
+        detail::PyContainer args;
+        args << data;
+        auto func = this->get_func(this->setter);
+        func.call(args.to_tuple());
+    }
+
+    void set_clim(double vmin, double vmax)
+    {
+        detail::PyContainer args;
+        args << vmin << vmax;
+        auto func = this->get_func("set_clim");
+        func.call(args.to_tuple());
+    }
+
+private:
+    std::vector<npy_intp> shape;
+    std::string setter;
+};
+}  // namespace detail
+}  // namespace matplotlibcpp
+
+#endif  // !__PLT_ARTIST_HPP__
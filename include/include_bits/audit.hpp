@@ -0,0 +1,42 @@
+#ifndef __PLT_AUDIT_HPP__
+#define __PLT_AUDIT_HPP__
+
+#include "utility.hpp"
+
+namespace matplotlibcpp
+{
+namespace detail
+{
+/** Allocation counters of the interpreter, taken after a full collection.
+ * blocks is sys.getallocatedblocks(), objects the number of objects tracked by the gc.
+ * Calling an API repeatedly must leave both flat once matplotlib's caches are warm.
+ */
+struct AllocationCount
+{
+    long blocks;
+    long objects;
+};
+
+inline AllocationCount get_allocation_count()
+{
+    NewRef gc = PyImport_ImportModule("gc");
+    if (!gc) {
+        throw std::runtime_error("Error loading module gc!");
+    }
+    NewRef collected = PyObject_CallMethod(gc, "collect", nullptr);
+
+    AllocationCount count;
+    {
+        NewRef objects = PyObject_CallMethod(gc, "get_objects", nullptr);
+        count.objects  = long(PyList_Size(objects));
+    }
+    // sys.getallocatedblocks is borrowed from the sys module
+    PyObject* getallocatedblocks = PySys_GetObject("getallocatedblocks");
+    NewRef blocks                = PyObject_CallObject(getallocatedblocks, nullptr);
+    count.blocks                 = PyLong_AsLong(blocks);
+    return count;
+}
+}  // namespace detail
+}  // namespace matplotlibcpp
+
+#endif  // !__PLT_AUDIT_HPP__
@@ -1,12 +1,29 @@
 #ifndef __PLT_AXES_HPP__
 #define __PLT_AXES_HPP__
 
+#include <array>
+#include <cmath>
+#include <memory>
+#include "artist.hpp"
+#include "band.hpp"
+#include "categorical.hpp"
+#include "collections.hpp"
+#include "contour.hpp"
+#include "datetime.hpp"
+#include "quiver.hpp"
+#include "raster.hpp"
+#include "sparse.hpp"
+#include "stats.hpp"
+#include "text.hpp"
 #include "utility.hpp"
 
 namespace matplotlibcpp
 {
 namespace detail
 {
+/** Handle of a matplotlib Axes, or of the ndarray of Axes returned by subplots.
+ * The handle owns a reference to the axes, copies share it.
+ */
 class Axes
 {
 public:
@@ -17,15 +34,86 @@ public:
         if (!ax) {
             throw std::runtime_error("ax is nullptr");
         }
+        Py_INCREF(this->ax);
+        if (this->is_grid()) {
+            auto axes   = (PyObject**)PyArray_DATA((PyArrayObject*)this->ax);
+            this->cells = std::make_shared<std::vector<Axes>>(axes, axes + this->nrows * this->ncols);
+        }
+    }
+
+    Axes(const Axes& other)
+        : ax(other.ax), nrows(other.nrows), ncols(other.ncols), cells(other.cells), selection(other.selection)
+    {
+        Py_XINCREF(this->ax);
+    }
+
+    Axes& operator=(const Axes& other)
+    {
+        Py_XINCREF(other.ax);
+        Py_XDECREF(this->ax);
+        this->ax        = other.ax;
+        this->nrows     = other.nrows;
+        this->ncols     = other.ncols;
+        this->cells     = other.cells;
+        this->selection = other.selection;
+        return *this;
     }
 
-    Axes operator[](int i)
+    ~Axes()
+    {
+        Py_XDECREF(this->ax);
+    }
+
+    /**
+     * @brief Cell i (row-major) of a grid returned by subplots.
+     *
+     * The cell handles are created once and shared by all copies of the grid,
+     * so the returned reference stays valid as long as the grid.
+     */
+    Axes& operator[](int i)
     {
         long tot_size = this->nrows * this->ncols;
         assert((tot_size != 1) && (tot_size > i));
-        auto tmp  = (PyArrayObject*)this->ax;
-        auto axes = (PyObject**)PyArray_DATA(tmp);
-        return Axes(axes[i]);
+        return this->get_cells()[i];
+    }
+
+    Axes& operator()(int row, int col)
+    {
+        return (*this)[row * this->ncols + col];
+    }
+
+    /**
+     * @brief The same grid, restricted to the given cells for the grid operations.
+     *
+     * Setters (set_xlim, set_title, grid, set_xticks, ...) called on a grid apply to all
+     * its selected cells, the arguments are converted only once for all of them.
+     */
+    Axes select(const std::vector<long>& indices) const
+    {
+        Axes grid(*this);
+        grid.selection = indices;
+        return grid;
+    }
+
+    Axes row(long i) const
+    {
+        std::vector<long> indices(this->ncols);
+        std::iota(indices.begin(), indices.end(), i * this->ncols);
+        return this->select(indices);
+    }
+
+    Axes col(long j) const
+    {
+        std::vector<long> indices(this->nrows);
+        for (long i = 0; i < this->nrows; ++i) {
+            indices[i] = i * this->ncols + j;
+        }
+        return this->select(indices);
+    }
+
+    long size() const
+    {
+        return this->is_grid() ? long(this->get_selection().size()) : 1;
     }
 
     template <typename ScalarX = double, typename ScalarY = double>
@@ -62,6 +150,878 @@ public:
         this->plot<Scalar>(y, "", keywords);
     }
 
+    void plot(const MemMap& x, const MemMap& y, const std::string& format = "", const KeyWords& keywords = {})
+    {
+        assert(this->nrows * this->ncols == 1);
+        detail::PyContainer args;
+        args << x << y << format;
+        auto func = this->get_func("plot");
+        func.call(args.to_tuple(), detail::get_keywords(keywords));
+    }
+
+    void plot(const MemMap& y, const std::string& format = "", const KeyWords& keywords = {})
+    {
+        assert(this->nrows * this->ncols == 1);
+        detail::PyContainer args;
+        args << y << format;
+        auto func = this->get_func("plot");
+        func.call(args.to_tuple(), detail::get_keywords(keywords));
+    }
+
+    void scatter(const MemMap& x, const MemMap& y, double s = 1.0, const KeyWords& keywords = {})
+    {
+        assert(this->nrows * this->ncols == 1);
+        detail::PyContainer args;
+        args << x << y;
+        auto kwargs = detail::get_keywords(keywords);
+        detail::set_item(kwargs, "s", PyFloat_FromDouble(s));
+        auto func = this->get_func("scatter");
+        func.call(args.to_tuple(), kwargs);
+    }
+
+    void hist(const MemMap& y, long bins = 10, std::string color = "b", double alpha = 1.0, bool cumulative = false)
+    {
+        assert(this->nrows * this->ncols == 1);
+        detail::NewRef kwargs = PyDict_New();
+        detail::set_item(kwargs, "bins", PyLong_FromLong(bins));
+        detail::set_item(kwargs, "color", PyUnicode_FromString(color.c_str()));
+        detail::set_item(kwargs, "alpha", PyFloat_FromDouble(alpha));
+        PyDict_SetItemString(kwargs, "cumulative", cumulative ? Py_True : Py_False);
+
+        detail::PyContainer args;
+        args << y;
+        auto func = this->get_func("hist");
+        func.call(args.to_tuple(), kwargs);
+    }
+
+    void plot(const ArrayHandle& x, const ArrayHandle& y, const std::string& format = "", const KeyWords& keywords = {})
+    {
+        assert(this->nrows * this->ncols == 1);
+        detail::PyContainer args;
+        args << x << y << format;
+        auto func = this->get_func("plot");
+        func.call(args.to_tuple(), detail::get_keywords(keywords));
+    }
+
+    void plot(const ArrayHandle& y, const std::string& format = "", const KeyWords& keywords = {})
+    {
+        assert(this->nrows * this->ncols == 1);
+        detail::PyContainer args;
+        args << y << format;
+        auto func = this->get_func("plot");
+        func.call(args.to_tuple(), detail::get_keywords(keywords));
+    }
+
+    void scatter(const ArrayHandle& x, const ArrayHandle& y, double s = 1.0, const KeyWords& keywords = {})
+    {
+        assert(this->nrows * this->ncols == 1);
+        detail::PyContainer args;
+        args << x << y;
+        auto kwargs = detail::get_keywords(keywords);
+        detail::set_item(kwargs, "s", PyFloat_FromDouble(s));
+        auto func = this->get_func("scatter");
+        func.call(args.to_tuple(), kwargs);
+    }
+
+    /**
+     * @brief Display an array that lives in python, new frames are swapped in with Image::set_data(ArrayHandle).
+     */
+    detail::Image imshow(const ArrayHandle& data,
+                         double vmin              = NAN,
+                         double vmax              = NAN,
+                         const KeyWords& keywords = {})
+    {
+        assert(this->nrows * this->ncols == 1);
+        detail::NewRef array = detail::get_array(data);
+        PyArrayObject* a     = (PyArrayObject*)(PyObject*)array;
+        std::vector<npy_intp> shape(PyArray_DIMS(a), PyArray_DIMS(a) + PyArray_NDIM(a));
+        detail::PyContainer args;
+        args << array;
+        auto kwargs = detail::get_keywords(keywords);
+        if (!std::isnan(vmin)) {
+            detail::set_item(kwargs, "vmin", PyFloat_FromDouble(vmin));
+        }
+        if (!std::isnan(vmax)) {
+            detail::set_item(kwargs, "vmax", PyFloat_FromDouble(vmax));
+        }
+        auto func = this->get_func("imshow");
+        func.call(args.to_tuple(), kwargs);
+        return detail::Image(func.res, shape);
+    }
+
+    void hist(const ArrayHandle& y, long bins = 10, const KeyWords& keywords = {})
+    {
+        assert(this->nrows * this->ncols == 1);
+        detail::PyContainer args;
+        args << y;
+        auto kwargs = detail::get_keywords(keywords);
+        detail::set_item(kwargs, "bins", PyLong_FromLong(bins));
+        auto func = this->get_func("hist");
+        func.call(args.to_tuple(), kwargs);
+    }
+
+    void bar(const ArrayHandle& x, const ArrayHandle& height, const KeyWords& keywords = {})
+    {
+        this->call_arrays("bar", {x, height}, keywords);
+    }
+
+    void barh(const ArrayHandle& y, const ArrayHandle& width, const KeyWords& keywords = {})
+    {
+        this->call_arrays("barh", {y, width}, keywords);
+    }
+
+    void stem(const ArrayHandle& x, const ArrayHandle& y, const KeyWords& keywords = {})
+    {
+        this->call_arrays("stem", {x, y}, keywords);
+    }
+
+    void fill_between(const ArrayHandle& x,
+                      const ArrayHandle& y1,
+                      const ArrayHandle& y2,
+                      const KeyWords& keywords = {})
+    {
+        this->call_arrays("fill_between", {x, y1, y2}, keywords);
+    }
+
+    void errorbar(const ArrayHandle& x, const ArrayHandle& y, const ArrayHandle& yerr, const KeyWords& keywords = {})
+    {
+        assert(this->nrows * this->ncols == 1);
+        detail::PyContainer args;
+        args << x << y;
+        auto kwargs = detail::get_keywords(keywords);
+        PyDict_SetItemString(kwargs, "yerr", detail::get_array(yerr));
+        auto func = this->get_func("errorbar");
+        func.call(args.to_tuple(), kwargs);
+    }
+
+    /**
+     * @brief matplotlib's contour of the rows x cols array z, x and y have cols and rows values.
+     */
+    detail::Artist contour(const ArrayHandle& x,
+                           const ArrayHandle& y,
+                           const ArrayHandle& z,
+                           const KeyWords& keywords = {})
+    {
+        auto func = this->call_arrays("contour", {x, y, z}, keywords);
+        return detail::Artist(func.res);
+    }
+
+    /**
+     * @brief plot against timestamps, the x axis becomes a date axis.
+     */
+    template <typename ScalarY = double>
+    void plot(const TimeStamps& t,
+              const std::vector<ScalarY>& y,
+              const std::string& format = "",
+              const KeyWords& keywords  = {})
+    {
+        assert(this->nrows * this->ncols == 1 && t.size == y.size());
+        detail::PyContainer args;
+        args << detail::get_datetime64(t) << detail::get_pyarray(y) << format;
+        auto func = this->get_func("plot");
+        func.call(args.to_tuple(), detail::get_keywords(keywords));
+        detail::set_date_formatter(this->ax);
+    }
+
+    template <typename Clock, typename Duration, typename ScalarY = double>
+    void plot(const std::vector<std::chrono::time_point<Clock, Duration>>& t,
+              const std::vector<ScalarY>& y,
+              const std::string& format = "",
+              const KeyWords& keywords  = {})
+    {
+        this->plot(TimeStamps(t), y, format, keywords);
+    }
+
+    template <typename ScalarY = double>
+    void scatter(const TimeStamps& t, const std::vector<ScalarY>& y, double s = 1.0, const KeyWords& keywords = {})
+    {
+        assert(this->nrows * this->ncols == 1 && t.size == y.size());
+        detail::PyContainer args;
+        args << detail::get_datetime64(t) << detail::get_pyarray(y);
+        auto kwargs = detail::get_keywords(keywords);
+        detail::set_item(kwargs, "s", PyFloat_FromDouble(s));
+        auto func = this->get_func("scatter");
+        func.call(args.to_tuple(), kwargs);
+        detail::set_date_formatter(this->ax);
+    }
+
+    template <typename Clock, typename Duration, typename ScalarY = double>
+    void scatter(const std::vector<std::chrono::time_point<Clock, Duration>>& t,
+                 const std::vector<ScalarY>& y,
+                 double s                 = 1.0,
+                 const KeyWords& keywords = {})
+    {
+        this->scatter(TimeStamps(t), y, s, keywords);
+    }
+
+    template <typename ScalarY1 = double, typename ScalarY2 = double>
+    void fill_between(const TimeStamps& t,
+                      const std::vector<ScalarY1>& y1,
+                      const std::vector<ScalarY2>& y2,
+                      const KeyWords& keywords = {})
+    {
+        assert(this->nrows * this->ncols == 1 && t.size == y1.size() && t.size == y2.size());
+        detail::PyContainer args;
+        args << detail::get_datetime64(t) << detail::get_pyarray(y1) << detail::get_pyarray(y2);
+        auto func = this->get_func("fill_between");
+        func.call(args.to_tuple(), detail::get_keywords(keywords));
+        detail::set_date_formatter(this->ax);
+    }
+
+    template <typename Clock, typename Duration, typename ScalarY1 = double, typename ScalarY2 = double>
+    void fill_between(const std::vector<std::chrono::time_point<Clock, Duration>>& t,
+                      const std::vector<ScalarY1>& y1,
+                      const std::vector<ScalarY2>& y2,
+                      const KeyWords& keywords = {})
+    {
+        this->fill_between(TimeStamps(t), y1, y2, keywords);
+    }
+
+    /**
+     * @brief Bars at the positions of the categories, which label the x ticks.
+     */
+    template <typename Scalar = double>
+    void bar(const Categories& x, const std::vector<Scalar>& height, const KeyWords& keywords = {})
+    {
+        this->categorical("bar", x, height, keywords);
+    }
+
+    template <typename Scalar = double>
+    void barh(const Categories& y, const std::vector<Scalar>& width, const KeyWords& keywords = {})
+    {
+        this->categorical("barh", y, width, keywords);
+    }
+
+    template <typename ScalarY = double>
+    void plot(const Categories& x,
+              const std::vector<ScalarY>& y,
+              const std::string& format = "",
+              const KeyWords& keywords  = {})
+    {
+        assert(this->nrows * this->ncols == 1 && x.size() == y.size());
+        detail::PyContainer args;
+        args << detail::get_pyarray(x.codes) << detail::get_pyarray(y) << format;
+        auto func = this->get_func("plot");
+        func.call(args.to_tuple(), detail::get_keywords(keywords));
+        detail::set_categories(this->ax, x, "xaxis");
+    }
+
+    template <typename ScalarY = double>
+    void scatter(const Categories& x, const std::vector<ScalarY>& y, double s = 1.0, const KeyWords& keywords = {})
+    {
+        assert(this->nrows * this->ncols == 1 && x.size() == y.size());
+        detail::PyContainer args;
+        args << detail::get_pyarray(x.codes) << detail::get_pyarray(y);
+        auto kwargs = detail::get_keywords(keywords);
+        detail::set_item(kwargs, "s", PyFloat_FromDouble(s));
+        auto func = this->get_func("scatter");
+        func.call(args.to_tuple(), kwargs);
+        detail::set_categories(this->ax, x, "xaxis");
+    }
+
+    /**
+     * @brief One collection with a marker area per point in points^2, s is empty for the default size.
+     */
+    template <typename ScalarX = double, typename ScalarY = double, typename ScalarS = double>
+    void scatter(const std::vector<ScalarX>& x,
+                 const std::vector<ScalarY>& y,
+                 const std::vector<ScalarS>& s,
+                 const KeyWords& keywords = {})
+    {
+        auto kwargs = detail::get_keywords(keywords);
+        this->scatter_arrays(x, y, s, kwargs);
+    }
+
+    /**
+     * @brief One collection colored by mapping c through the colormap, e.g. {{"cmap", "viridis"}}.
+     *
+     * vmin and vmax default to the range of c.
+     */
+    template <typename ScalarX = double, typename ScalarY = double, typename ScalarS = double, typename ScalarC = double>
+    void scatter(const std::vector<ScalarX>& x,
+                 const std::vector<ScalarY>& y,
+                 const std::vector<ScalarS>& s,
+                 const std::vector<ScalarC>& c,
+                 double vmin              = NAN,
+                 double vmax              = NAN,
+                 const KeyWords& keywords = {})
+    {
+        assert(c.size() == x.size());
+        auto kwargs = detail::get_keywords(keywords);
+        PyDict_SetItemString(kwargs, "c", detail::get_pyarray(c));
+        if (!std::isnan(vmin))
+            detail::set_item(kwargs, "vmin", PyFloat_FromDouble(vmin));
+        if (!std::isnan(vmax))
+            detail::set_item(kwargs, "vmax", PyFloat_FromDouble(vmax));
+        this->scatter_arrays(x, y, s, kwargs);
+    }
+
+    /**
+     * @brief One collection with an RGBA color per point, 0-255 for integer channels and 0-1 otherwise.
+     */
+    template <typename ScalarX = double, typename ScalarY = double, typename ScalarS = double, typename Channel>
+    void scatter(const std::vector<ScalarX>& x,
+                 const std::vector<ScalarY>& y,
+                 const std::vector<ScalarS>& s,
+                 const std::vector<std::array<Channel, 4>>& rgba,
+                 const KeyWords& keywords = {})
+    {
+        static_assert(sizeof(std::array<Channel, 4>) == 4 * sizeof(Channel), "RGBA colors must be packed");
+        assert(rgba.size() == x.size());
+        auto kwargs = detail::get_keywords(keywords);
+        const Channel* channels = rgba.empty() ? nullptr : rgba[0].data();
+        if (std::is_integral<Channel>::value) {
+            std::vector<float> colors(4 * rgba.size());
+            for (std::size_t k = 0; k < colors.size(); ++k) {
+                colors[k] = float(channels[k]) / 255.0f;
+            }
+            PyDict_SetItemString(kwargs, "c", detail::get_pyarray(colors.data(), {npy_intp(rgba.size()), 4}));
+        } else {
+            PyDict_SetItemString(kwargs, "c", detail::get_pyarray(channels, {npy_intp(rgba.size()), 4}));
+        }
+        this->scatter_arrays(x, y, s, kwargs);
+    }
+
+    /**
+     * @brief Rasterize the polyline natively into an image layer, see RasterOptions.
+     */
+    template <typename ScalarX = double, typename ScalarY = double>
+    void plot(const std::vector<ScalarX>& x,
+              const std::vector<ScalarY>& y,
+              const RasterOptions& options,
+              const KeyWords& keywords = {})
+    {
+        assert(x.size() == y.size());
+        this->rasterize(x.data(), y.data(), x.size(), true, options, keywords);
+    }
+
+    /**
+     * @brief Rasterize the points natively into an image layer, see RasterOptions.
+     */
+    template <typename ScalarX = double, typename ScalarY = double>
+    void scatter(const std::vector<ScalarX>& x,
+                 const std::vector<ScalarY>& y,
+                 const RasterOptions& options,
+                 const KeyWords& keywords = {})
+    {
+        assert(x.size() == y.size());
+        this->rasterize(x.data(), y.data(), x.size(), false, options, keywords);
+    }
+
+    /**
+     * @brief Display a rows x cols row-major scalar field.
+     *
+     * The buffer is handed to matplotlib without copying. Fixing vmin/vmax keeps
+     * the norm from being recomputed when frames are swapped in with Image::set_data.
+     */
+    template <typename Scalar>
+    detail::Image imshow(const Scalar* data, long rows, long cols, const KeyWords& keywords = {})
+    {
+        detail::PyContainer args;
+        return this->image("imshow", args, data, {rows, cols}, NAN, NAN, keywords);
+    }
+
+    template <typename Scalar>
+    detail::Image imshow(const Scalar* data,
+                         long rows,
+                         long cols,
+                         double vmin,
+                         double vmax,
+                         const KeyWords& keywords = {})
+    {
+        detail::PyContainer args;
+        return this->image("imshow", args, data, {rows, cols}, vmin, vmax, keywords);
+    }
+
+    /**
+     * @brief Display a rows x cols RGB (channels = 3) or RGBA (channels = 4) image without copying.
+     */
+    detail::Image imshow(const std::uint8_t* data, long rows, long cols, long channels, const KeyWords& keywords = {})
+    {
+        assert(channels == 3 || channels == 4);
+        detail::PyContainer args;
+        return this->image("imshow", args, data, {rows, cols, channels}, NAN, NAN, keywords);
+    }
+
+    template <typename Scalar>
+    detail::Image matshow(const Scalar* data,
+                          long rows,
+                          long cols,
+                          double vmin              = NAN,
+                          double vmax              = NAN,
+                          const KeyWords& keywords = {})
+    {
+        detail::PyContainer args;
+        return this->image("matshow", args, data, {rows, cols}, vmin, vmax, keywords);
+    }
+
+    template <typename Scalar>
+    detail::Image pcolormesh(const Scalar* data,
+                             long rows,
+                             long cols,
+                             double vmin              = NAN,
+                             double vmax              = NAN,
+                             const KeyWords& keywords = {})
+    {
+        detail::PyContainer args;
+        return this->image("pcolormesh", args, data, {rows, cols}, vmin, vmax, keywords);
+    }
+
+    /**
+     * @brief pcolormesh with cell edges, x has cols + 1 and y has rows + 1 elements.
+     */
+    template <typename ScalarX = double, typename ScalarY = double, typename Scalar = double>
+    detail::Image pcolormesh(const std::vector<ScalarX>& x,
+                             const std::vector<ScalarY>& y,
+                             const Scalar* data,
+                             long rows,
+                             long cols,
+                             double vmin              = NAN,
+                             double vmax              = NAN,
+                             const KeyWords& keywords = {})
+    {
+        assert(long(x.size()) == cols + 1 && long(y.size()) == rows + 1);
+        detail::PyContainer args;
+        args << detail::get_pyarray(x) << detail::get_pyarray(y);
+        return this->image("pcolormesh", args, data, {rows, cols}, vmin, vmax, keywords);
+    }
+
+    /**
+     * @brief Contour lines of z computed natively, z is row-major with y.size() rows and x.size() columns.
+     *
+     * With options.filled the bands between consecutive levels are filled instead.
+     * The result is a matplotlib ContourSet, which can be passed to colorbar and clabel.
+     */
+    template <typename ScalarX = double, typename ScalarY = double, typename ScalarZ = double>
+    detail::Artist contour(const std::vector<ScalarX>& x,
+                           const std::vector<ScalarY>& y,
+                           const ScalarZ* z,
+                           const std::vector<double>& levels,
+                           const ContourOptions& options,
+                           const KeyWords& keywords = {})
+    {
+        assert(this->nrows * this->ncols == 1);
+        assert(x.size() >= 2 && y.size() >= 2 && std::is_sorted(levels.begin(), levels.end()));
+        detail::ContourGenerator<ScalarX, ScalarY, ScalarZ> generator(x.data(), y.data(), z, long(y.size()),
+                                                                      long(x.size()), options.nthreads);
+        auto paths = options.filled ? generator.bands(levels) : generator.lines(levels);
+        return this->contour_set(paths, levels, options.filled, double(x[0]), double(y[0]), keywords);
+    }
+
+    /**
+     * @brief Native contour with about nlevels levels chosen like matplotlib does.
+     */
+    template <typename ScalarX = double, typename ScalarY = double, typename ScalarZ = double>
+    detail::Artist contour(const std::vector<ScalarX>& x,
+                           const std::vector<ScalarY>& y,
+                           const ScalarZ* z,
+                           long nlevels,
+                           const ContourOptions& options,
+                           const KeyWords& keywords = {})
+    {
+        double zmin = INFINITY, zmax = -INFINITY;
+        for (std::size_t i = 0; i < x.size() * y.size(); ++i) {
+            if (std::isfinite(double(z[i]))) {
+                zmin = std::min(zmin, double(z[i]));
+                zmax = std::max(zmax, double(z[i]));
+            }
+        }
+        return this->contour(x, y, z, detail::get_contour_levels(zmin, zmax, nlevels, options.filled), options,
+                             keywords);
+    }
+
+    /**
+     * @brief quiver of the field u, v on a structured grid, row-major with y.size() rows and x.size() columns.
+     *
+     * The field is decimated in C++ to the arrow density of the options.
+     */
+    template <typename ScalarX = double, typename ScalarY = double, typename ScalarU = double, typename ScalarV = double>
+    detail::Artist quiver(const std::vector<ScalarX>& x,
+                          const std::vector<ScalarY>& y,
+                          const ScalarU* u,
+                          const ScalarV* v,
+                          const QuiverOptions& options,
+                          const KeyWords& keywords = {})
+    {
+        assert(this->nrows * this->ncols == 1);
+        auto field = detail::get_quiver_field(x, y, u, v, options);
+        npy_intp ny = npy_intp(field.Y.size()), nx = npy_intp(field.X.size());
+
+        detail::PyContainer args;
+        args << detail::get_pyarray(field.X) << detail::get_pyarray(field.Y)
+             << detail::get_pyarray(field.U.data(), {ny, nx}) << detail::get_pyarray(field.V.data(), {ny, nx});
+        if (options.colored) {
+            args << detail::get_pyarray(field.C.data(), {ny, nx});
+        }
+        auto func = this->get_func("quiver");
+        func.call(args.to_tuple(), detail::get_keywords(keywords));
+        return detail::Artist(func.res);
+    }
+
+    /**
+     * @brief Box plot with the statistics computed in C++, one thread per group, drawn with Axes.bxp.
+     *
+     * whis is a factor of the IQR like "1.5" or percentiles like "(5, 95)". whis, notch, sym,
+     * positions and widths are handled here, the other keywords are passed to bxp. With
+     * bootstrap, usermedians, conf_intervals or autorange the plot is made by Axes.boxplot.
+     */
+    template <typename Scalar = double>
+    void boxplot(const std::vector<std::vector<Scalar>>& data,
+                 const std::vector<std::string>& labels = {},
+                 const KeyWords& keywords               = {})
+    {
+        assert(this->nrows * this->ncols == 1);
+        KeyWords rest = keywords;
+        auto whis     = detail::to_numbers(detail::pop_keyword(rest, "whis", "1.5"));
+        if (whis.size() > 2 || (whis.size() == 2 && !(0 <= whis[0] && whis[0] <= whis[1] && whis[1] <= 100))) {
+            throw std::runtime_error("boxplot: whis must be a number or a pair of percentiles: " + keywords.at("whis"));
+        }
+        bool notch      = detail::to_bool(detail::pop_keyword(rest, "notch", "False"));
+        bool has_sym    = rest.count("sym") > 0;
+        std::string sym = detail::pop_keyword(rest, "sym");
+        bool by_boxplot = false;
+        for (const char* key : {"bootstrap", "usermedians", "conf_intervals", "autorange"}) {
+            by_boxplot = by_boxplot || rest.count(key) > 0;
+        }
+
+        KeyWords numeric;
+        for (const char* key : {"positions", "widths", "bootstrap", "usermedians", "conf_intervals"}) {
+            if (rest.count(key)) {
+                numeric[key] = detail::pop_keyword(rest, key);
+            }
+        }
+        auto kwargs = detail::get_keywords(rest, {"vert", "patch_artist", "showmeans", "showcaps", "showbox",
+                                                  "showfliers", "meanline", "manage_ticks", "autorange"});
+        for (const auto& item : numeric) {
+            auto numbers = detail::to_numbers(item.second);
+            if (item.first == "bootstrap") {
+                detail::set_item(kwargs, item.first, PyLong_FromLong(long(numbers[0])));
+            } else if (item.first == "conf_intervals") {
+                PyDict_SetItemString(kwargs, item.first.c_str(),
+                                     detail::get_pyarray(numbers.data(), {npy_intp(numbers.size() / 2), 2}));
+            } else if (item.first == "widths" && numbers.size() == 1) {
+                detail::set_item(kwargs, item.first, PyFloat_FromDouble(numbers[0]));
+            } else {
+                PyDict_SetItemString(kwargs, item.first.c_str(), detail::get_pyarray(numbers));
+            }
+        }
+        if (has_sym) {
+            this->set_flierprops(kwargs, sym);
+        }
+
+        if (by_boxplot) {
+            detail::NewRef x = PyList_New(0);
+            for (const auto& group : data) {
+                PyList_Append(x, detail::get_pyarray(group));
+            }
+            detail::PyContainer args;
+            args << x;
+            detail::set_item(kwargs, "notch", PyBool_FromLong(notch));
+            detail::set_item(kwargs, "whis", whis.size() == 2 ? Py_BuildValue("(dd)", whis[0], whis[1])
+                                                              : PyFloat_FromDouble(whis[0]));
+            auto func = this->get_func("boxplot");
+            func.call(args.to_tuple(), kwargs);
+            // at the ticks placed by boxplot, its keyword for labels differs between matplotlib versions
+            if (!labels.empty() && labels.size() == data.size()) {
+                std::vector<double> ticks(data.size());
+                for (std::size_t k = 0; k < ticks.size(); ++k) {
+                    ticks[k] = double(k + 1);
+                }
+                if (numeric.count("positions")) {
+                    ticks = detail::to_numbers(numeric["positions"]);
+                }
+                if (detail::to_bool(detail::pop_keyword(rest, "vert", "True"))) {
+                    this->set_xticks(ticks, labels);
+                } else {
+                    this->set_yticks(ticks, labels);
+                }
+            }
+            return;
+        }
+
+        std::vector<detail::BoxStats> stats(data.size());
+        detail::parallel_for(data.size(), 0, [&](std::size_t k) { stats[k] = detail::get_box_stats(data[k], whis); });
+
+        detail::NewRef bxpstats = PyList_New(0);
+        for (std::size_t k = 0; k < stats.size(); ++k) {
+            PyList_Append(bxpstats, detail::get_pydict(stats[k], labels.size() == data.size() ? labels[k] : ""));
+        }
+        detail::PyContainer args;
+        args << bxpstats;
+        detail::set_item(kwargs, "shownotches", PyBool_FromLong(notch));
+        auto func = this->get_func("bxp");
+        func.call(args.to_tuple(), kwargs);
+    }
+
+    /**
+     * @brief Violin plot with the statistics and the kernel density estimate computed in C++, drawn with
+     * Axes.violin.
+     *
+     * The density is evaluated at the number of points given by the points keyword (default 100),
+     * positions and widths take a number or a list like "[1, 2.5, 4]", the labels are placed at
+     * the positions. The other keywords are passed to violin.
+     */
+    template <typename Scalar = double>
+    void violinplot(const std::vector<std::vector<Scalar>>& data,
+                    const std::vector<std::string>& labels = {},
+                    const KeyWords& keywords               = {})
+    {
+        assert(this->nrows * this->ncols == 1);
+        KeyWords rest = keywords;
+        long npoints  = std::strtol(detail::pop_keyword(rest, "points", "100").c_str(), nullptr, 10);
+        bool vert     = detail::to_bool(detail::pop_keyword(rest, "vert", "True"));
+
+        std::vector<detail::ViolinStats> stats(data.size());
+        detail::parallel_for(data.size(), 0,
+                             [&](std::size_t k) { stats[k] = detail::get_violin_stats(data[k], npoints); });
+
+        detail::NewRef vpstats = PyList_New(0);
+        for (const auto& violin : stats) {
+            PyList_Append(vpstats, detail::get_pydict(violin));
+        }
+        std::vector<double> positions(data.size());
+        for (std::size_t k = 0; k < positions.size(); ++k) {
+            positions[k] = double(k + 1);
+        }
+        if (rest.count("positions")) {
+            positions = detail::to_numbers(detail::pop_keyword(rest, "positions"));
+            if (positions.size() != data.size()) {
+                throw std::runtime_error("violinplot: positions needs one value per dataset");
+            }
+        }
+        std::vector<double> widths;
+        if (rest.count("widths")) {
+            widths = detail::to_numbers(detail::pop_keyword(rest, "widths"));
+        }
+
+        detail::PyContainer args;
+        args << vpstats;
+        auto kwargs = detail::get_keywords(rest, {"showmeans", "showextrema", "showmedians"});
+        detail::set_item(kwargs, "vert", PyBool_FromLong(vert));
+        PyDict_SetItemString(kwargs, "positions", detail::get_pylist(positions));
+        if (widths.size() == 1) {
+            detail::set_item(kwargs, "widths", PyFloat_FromDouble(widths[0]));
+        } else if (!widths.empty()) {
+            PyDict_SetItemString(kwargs, "widths", detail::get_pylist(widths));
+        }
+        auto func = this->get_func("violin");
+        func.call(args.to_tuple(), kwargs);
+
+        if (labels.size() == data.size()) {
+            const auto& ticks = positions;
+            detail::PyContainer tick_args;
+            tick_args << detail::get_pyarray(ticks) << detail::get_unicode_array(labels);
+            auto set_ticks = this->get_func(vert ? "set_xticks" : "set_yticks");
+            set_ticks.call(tick_args.to_tuple());
+        }
+    }
+
+    /**
+     * @brief Band plot of the aggregated samples, the center line is drawn with the keywords
+     * and the envelope is filled in the same color.
+     */
+    detail::Artist band(const BandAggregator& aggregator, const KeyWords& keywords = {})
+    {
+        assert(this->nrows * this->ncols == 1);
+        std::vector<double> x, center, lower, upper;
+        aggregator.get_band(x, center, lower, upper);
+
+        detail::PyContainer args;
+        args << detail::get_pyarray(x) << detail::get_pyarray(center);
+        auto plot = this->get_func("plot");
+        plot.call(args.to_tuple(), detail::get_keywords(keywords));
+        detail::NewRef color = PyObject_CallMethod(PyList_GetItem(plot.res, 0), "get_color", nullptr);
+
+        detail::PyContainer fill_args;
+        fill_args << detail::get_pyarray(x) << detail::get_pyarray(lower) << detail::get_pyarray(upper);
+        detail::NewRef kwargs = PyDict_New();
+        PyDict_SetItemString(kwargs, "color", color);
+        detail::set_item(kwargs, "alpha", PyFloat_FromDouble(aggregator.get_options().alpha));
+        detail::set_item(kwargs, "linewidth", PyFloat_FromDouble(0.0));
+        auto fill = this->get_func("fill_between");
+        fill.call(fill_args.to_tuple(), kwargs);
+        return detail::Artist(fill.res);
+    }
+
+    /**
+     * @brief Band plot of raw samples, bucketed over the x range of the samples.
+     */
+    template <typename ScalarX = double, typename ScalarY = double>
+    detail::Artist band(const std::vector<ScalarX>& x,
+                        const std::vector<ScalarY>& y,
+                        const BandOptions& options = BandOptions(),
+                        const KeyWords& keywords   = {})
+    {
+        assert(x.size() == y.size());
+        auto extent = detail::get_extent(x.data(), y.data(), x.size());
+        BandAggregator aggregator(extent[0], extent[1], options);
+        aggregator.add(x, y);
+        return this->band(aggregator, keywords);
+    }
+
+    /**
+     * @brief Sparsity pattern of a CSR matrix without densifying it, see SpyOptions.
+     */
+    template <typename Index = long, typename Scalar = double>
+    detail::Artist spy(const CsrMatrix<Index, Scalar>& matrix,
+                       const SpyOptions& options = SpyOptions(),
+                       const KeyWords& keywords  = {})
+    {
+        return this->spy_matrix(matrix, options, keywords);
+    }
+
+    /**
+     * @brief Sparsity pattern of a COO matrix without densifying it, see SpyOptions.
+     */
+    template <typename Index = long, typename Scalar = double>
+    detail::Artist spy(const CooMatrix<Index, Scalar>& matrix,
+                       const SpyOptions& options = SpyOptions(),
+                       const KeyWords& keywords  = {})
+    {
+        return this->spy_matrix(matrix, options, keywords);
+    }
+
+    /**
+     * @brief Labels at the data positions x, y, created as annotations sharing their keywords.
+     *
+     * With options.cull, the positions are transformed to display coordinates in one call
+     * and overlapping labels are dropped in C++ before any artist is created.
+     * Returns the indices of the labels that were drawn.
+     */
+    template <typename ScalarX = double, typename ScalarY = double>
+    std::vector<std::size_t> texts(const std::vector<ScalarX>& x,
+                                   const std::vector<ScalarY>& y,
+                                   const std::vector<std::string>& labels,
+                                   const TextStyles& styles   = {},
+                                   const TextOptions& options = TextOptions(),
+                                   const KeyWords& keywords   = {})
+    {
+        assert(this->nrows * this->ncols == 1);
+        assert(x.size() == labels.size() && y.size() == labels.size());
+        assert(styles.offsets.empty() || styles.offsets.size() == 2 * labels.size());
+        assert(styles.colors.empty() || styles.colors.size() == 4 * labels.size());
+        assert(styles.sizes.empty() || styles.sizes.size() == labels.size());
+        std::size_t n = labels.size();
+
+        KeyWords rest  = keywords;
+        std::string ha = detail::pop_keyword(rest, "ha", detail::pop_keyword(rest, "horizontalalignment", "left"));
+        std::string va = detail::pop_keyword(rest, "va", detail::pop_keyword(rest, "verticalalignment", "baseline"));
+
+        std::vector<std::size_t> kept;
+        if (!options.cull) {
+            for (std::size_t k = 0; k < n; ++k) {
+                kept.push_back(k);
+            }
+        } else {
+            kept = this->cull_texts(x, y, labels, styles, options, ha, va, rest);
+        }
+
+        auto kwargs = detail::get_keywords(rest);
+        detail::set_item(kwargs, "ha", PyUnicode_FromString(ha.c_str()));
+        detail::set_item(kwargs, "va", PyUnicode_FromString(va.c_str()));
+        detail::set_item(kwargs, "textcoords", PyUnicode_FromString("offset points"));
+        detail::set_item(kwargs, "xytext", Py_BuildValue("(dd)", 0.0, 0.0));
+        auto func = this->get_func("annotate");
+        for (std::size_t k : kept) {
+            detail::NewRef args = Py_BuildValue("(s)", labels[k].c_str());
+            detail::set_item(kwargs, "xy", Py_BuildValue("(dd)", double(x[k]), double(y[k])));
+            if (!styles.offsets.empty()) {
+                detail::set_item(kwargs, "xytext", Py_BuildValue("(dd)", styles.offsets[2 * k], styles.offsets[2 * k + 1]));
+            }
+            if (!styles.colors.empty()) {
+                const double* c = &styles.colors[4 * k];
+                detail::set_item(kwargs, "color", Py_BuildValue("(dddd)", c[0], c[1], c[2], c[3]));
+            }
+            if (!styles.sizes.empty()) {
+                detail::set_item(kwargs, "fontsize", PyFloat_FromDouble(styles.sizes[k]));
+            }
+            func.call(args, kwargs);
+        }
+        return kept;
+    }
+
+    /**
+     * @brief Plot nlines lines sharing x as a single LineCollection.
+     *
+     * y is row-major nlines x x.size(). The axes are autoscaled once for all the lines.
+     */
+    template <typename ScalarX = double, typename ScalarY = double>
+    detail::Artist plot_many(const std::vector<ScalarX>& x,
+                             const ScalarY* y,
+                             long nlines,
+                             const LineStyles& styles = {},
+                             const KeyWords& keywords = {})
+    {
+        return this->add_line_collection(detail::get_segments(x, y, nlines), nlines, styles, keywords);
+    }
+
+    /**
+     * @brief Plot ragged lines as a single LineCollection, line i is made of the points offsets[i] to offsets[i + 1].
+     */
+    template <typename ScalarX = double, typename ScalarY = double>
+    detail::Artist line_collection(const std::vector<std::size_t>& offsets,
+                                   const ScalarX* x,
+                                   const ScalarY* y,
+                                   const LineStyles& styles = {},
+                                   const KeyWords& keywords = {})
+    {
+        return this->add_line_collection(detail::get_segments(offsets, x, y), long(offsets.size()) - 1, styles,
+                                         keywords);
+    }
+
+    /**
+     * @brief Plot ys[k] against the shared x in the k-th selected cell of a grid.
+     */
+    template <typename ScalarX = double, typename ScalarY = double>
+    void plot_each(const std::vector<ScalarX>& x,
+                   const std::vector<std::vector<ScalarY>>& ys,
+                   const std::string& format = "",
+                   const KeyWords& keywords  = {})
+    {
+        if (!this->is_grid()) {
+            assert(ys.size() <= 1);
+            for (const auto& y : ys) {
+                this->plot(x, y, format, keywords);
+            }
+            return;
+        }
+        assert(ys.size() <= this->get_selection().size());
+        auto xarray              = detail::get_pyarray(x);
+        detail::NewRef args_list = PyList_New(Py_ssize_t(ys.size()));
+        for (std::size_t k = 0; k < ys.size(); ++k) {
+            assert(ys[k].size() == x.size());
+            detail::PyContainer args;
+            args << xarray << detail::get_pyarray(ys[k]) << format;
+            detail::NewRef tuple = args.to_tuple();
+            Py_INCREF(tuple);
+            PyList_SetItem(args_list, Py_ssize_t(k), tuple);
+        }
+        this->call_each("plot", args_list, detail::get_keywords(keywords));
+    }
+
+    /**
+     * @brief Axes.set with the keywords, e.g. {{"xscale", "log"}, {"title", "a"}}.
+     */
+    void set(const KeyWords& keywords)
+    {
+        this->call("set", nullptr, detail::get_keywords(keywords));
+    }
+
+    void set_titles(const std::vector<std::string>& titles, const KeyWords& keywords = {})
+    {
+        this->call_each("set_title", titles, keywords);
+    }
+
+    void set_xlabels(const std::vector<std::string>& labels, const KeyWords& keywords = {})
+    {
+        this->call_each("set_xlabel", labels, keywords);
+    }
+
+    void set_ylabels(const std::vector<std::string>& labels, const KeyWords& keywords = {})
+    {
+        this->call_each("set_ylabel", labels, keywords);
+    }
+
     void grid(bool visible             = true,
               const std::string& which = "major",
               const std::string& axis  = "both",
@@ -69,52 +1029,42 @@ public:
     {
         detail::PyContainer args;
         args << visible << which << axis;
-        auto func = this->get_func("grid");
-        func.call(args.to_tuple(), detail::get_keywords(keywords));
+        this->call("grid", args.to_tuple(), detail::get_keywords(keywords));
     }
 
     void set_xlim(double left, double right)
     {
-        detail::PyContainer list;
-        list << left << right;
-        detail::NewRef args = PyTuple_New(1);
-        PyTuple_SetItem(args, 0, list.to_tuple());
-        auto func = this->get_func("set_xlim");
-        func.call(args);
+        detail::PyContainer args;
+        args << left << right;
+        this->call("set_xlim", args.to_tuple());
     }
 
     void set_ylim(double left, double right)
     {
-        detail::PyContainer list;
-        list << left << right;
-        detail::NewRef args = PyTuple_New(1);
-        PyTuple_SetItem(args, 0, list.to_tuple());
-        auto func = this->get_func("set_ylim");
-        func.call(args);
+        detail::PyContainer args;
+        args << left << right;
+        this->call("set_ylim", args.to_tuple());
     }
 
     void set_xlabel(const std::string& str, const KeyWords& keywords = {})
     {
         detail::PyContainer args;
         args << str;
-        auto func = this->get_func("set_xlabel");
-        func.call(args.to_tuple(), detail::get_keywords(keywords));
+        this->call("set_xlabel", args.to_tuple(), detail::get_keywords(keywords));
     }
 
     void set_ylabel(const std::string& str, const KeyWords& keywords = {})
     {
         detail::PyContainer args;
         args << str;
-        auto func = this->get_func("set_ylabel");
-        func.call(args.to_tuple(), detail::get_keywords(keywords));
+        this->call("set_ylabel", args.to_tuple(), detail::get_keywords(keywords));
     }
 
     void set_title(const std::string& str, const KeyWords& keywords = {})
     {
         detail::PyContainer args;
         args << str;
-        auto func = this->get_func("set_title");
-        func.call(args.to_tuple(), detail::get_keywords(keywords));
+        this->call("set_title", args.to_tuple(), detail::get_keywords(keywords));
     }
 
     template <typename Scalar = double>
@@ -124,12 +1074,11 @@ public:
     {
         assert(labels.size() == 0 || ticks.size() == labels.size());
         detail::PyContainer args;
-        args << ticks;
+        args << detail::get_pyarray(ticks);
         if (!labels.empty()) {
-            args << labels;
+            args << detail::get_unicode_array(labels);
         }
-        auto func = this->get_func("set_xticks");
-        func.call(args.to_tuple(), detail::get_keywords(keywords));
+        this->call("set_xticks", args.to_tuple(), detail::get_keywords(keywords));
     }
 
     template <typename Scalar = double>
@@ -139,20 +1088,18 @@ public:
     {
         assert(labels.size() == 0 || ticks.size() == labels.size());
         detail::PyContainer args;
-        args << ticks;
+        args << detail::get_pyarray(ticks);
         if (!labels.empty()) {
-            args << labels;
+            args << detail::get_unicode_array(labels);
         }
-        auto func = this->get_func("set_yticks");
-        func.call(args.to_tuple(), detail::get_keywords(keywords));
+        this->call("set_yticks", args.to_tuple(), detail::get_keywords(keywords));
     }
 
     void axvline(double x, double ymin = 0., double ymax = 1., const KeyWords& keywords = {})
     {
         detail::PyContainer args;
         args << x << ymin << ymax;
-        auto func = this->get_func("axvline");
-        func.call(args.to_tuple(), detail::get_keywords(keywords));
+        this->call("axvline", args.to_tuple(), detail::get_keywords(keywords));
     }
 
     void axvline(double x, const KeyWords& keywords)
@@ -164,8 +1111,7 @@ public:
     {
         detail::PyContainer args;
         args << y << xmin << xmax;
-        auto func = this->get_func("axhline");
-        func.call(args.to_tuple(), detail::get_keywords(keywords));
+        this->call("axhline", args.to_tuple(), detail::get_keywords(keywords));
     }
 
     void axhline(double y, const KeyWords& keywords)
@@ -177,36 +1123,31 @@ public:
     {
         detail::PyContainer args;
         args << x << ymin << ymax;
-        auto func = this->get_func("vlines");
-        func.call(args.to_tuple(), detail::get_keywords(keywords));
+        this->call("vlines", args.to_tuple(), detail::get_keywords(keywords));
     }
 
     void hlines(double y, double xmin, double xmax, const KeyWords& keywords = {})
     {
         detail::PyContainer args;
         args << y << xmin << xmax;
-        auto func = this->get_func("hlines");
-        func.call(args.to_tuple(), detail::get_keywords(keywords));
+        this->call("hlines", args.to_tuple(), detail::get_keywords(keywords));
     }
 
     void legend(const KeyWords& keywords = {})
     {
-        auto func = this->get_func("legend");
-        func.call(nullptr, detail::get_keywords(keywords));
+        this->call("legend", nullptr, detail::get_keywords(keywords));
     }
 
     detail::Axes twinx()
     {
         auto func = this->get_func("twinx");
         func.call();
-        func.incref_res();
         return detail::Axes(func.res);
     }
 
     void cla()
     {
-        auto func = this->get_func("cla");
-        func.call();
+        this->call("cla");
     }
 
     PyObject* get_ax()
@@ -220,10 +1161,477 @@ private:
         return Load_func(name, this->ax);
     }
 
+    bool is_grid() const
+    {
+        return this->nrows * this->ncols != 1;
+    }
+
+    std::vector<Axes>& get_cells() const
+    {
+        return *this->cells;
+    }
+
+    // tuple of the selected cells of a grid
+    detail::NewRef get_selected_axes() const
+    {
+        auto indices    = this->get_selection();
+        PyObject* tuple = PyTuple_New(Py_ssize_t(indices.size()));
+        for (std::size_t k = 0; k < indices.size(); ++k) {
+            PyObject* ax = this->get_cells()[indices[k]].ax;
+            Py_INCREF(ax);
+            PyTuple_SetItem(tuple, Py_ssize_t(k), ax);
+        }
+        return tuple;
+    }
+
+    // flierprops of a boxplot sym like "r+", "" hides the fliers as in Axes.boxplot
+    void set_flierprops(PyObject* kwargs, const std::string& sym)
+    {
+        if (sym.empty()) {
+            detail::set_item(kwargs, "flierprops",
+                             Py_BuildValue("{s:s,s:s,s:s}", "linestyle", "none", "marker", "", "color", "none"));
+            detail::set_item(kwargs, "showfliers", PyBool_FromLong(false));
+            return;
+        }
+        detail::NewRef base = PyImport_ImportModule("matplotlib.axes._base");
+        if (!base) {
+            throw std::runtime_error("Error loading module matplotlib.axes._base!");
+        }
+        detail::PyContainer args;
+        args << sym;
+        detail::Load_func format("_process_plot_format", base);
+        format.call(args.to_tuple());
+        PyObject* marker = PyTuple_GetItem(format.res, 1);
+        PyObject* color  = PyTuple_GetItem(format.res, 2);
+        detail::NewRef flierprops = PyDict_New();
+        if (marker != Py_None) {
+            PyDict_SetItemString(flierprops, "marker", marker);
+        }
+        if (color != Py_None) {
+            for (const char* key : {"color", "markerfacecolor", "markeredgecolor"}) {
+                PyDict_SetItemString(flierprops, key, color);
+            }
+        }
+        PyDict_SetItemString(kwargs, "flierprops", flierprops);
+    }
+
+    // Calls the method of a single axes with the arrays as positional arguments.
+    Load_func call_arrays(const std::string& name, const std::vector<ArrayHandle>& arrays, const KeyWords& keywords)
+    {
+        assert(this->nrows * this->ncols == 1);
+        detail::PyContainer args;
+        for (const auto& array : arrays) {
+            args << array;
+        }
+        auto func = this->get_func(name);
+        func.call(args.to_tuple(), detail::get_keywords(keywords));
+        return func;
+    }
+
+    std::vector<long> get_selection() const
+    {
+        if (!this->selection.empty()) {
+            return this->selection;
+        }
+        std::vector<long> indices(this->nrows * this->ncols);
+        std::iota(indices.begin(), indices.end(), 0L);
+        return indices;
+    }
+
+    // Calls the method of the axes, or of all selected cells of a grid with the same arguments in one call.
+    void call(const std::string& name, PyObject* args = nullptr, PyObject* kwargs = nullptr)
+    {
+        if (!this->is_grid()) {
+            auto func = this->get_func(name);
+            func.call(args, kwargs);
+            return;
+        }
+        detail::PyContainer apply_args;
+        apply_args << this->get_selected_axes() << name << detail::BorrowedRef(args ? args : Py_None)
+                   << detail::BorrowedRef(kwargs ? kwargs : Py_None);
+        detail::Load_func("apply", detail::get_grid_helpers()).call(apply_args.to_tuple());
+    }
+
+    // Calls the method of the k-th selected cell with the k-th tuple of args_list, all cells in one call.
+    void call_each(const std::string& name, const detail::NewRef& args_list, PyObject* kwargs)
+    {
+        detail::PyContainer apply_args;
+        apply_args << this->get_selected_axes() << name << args_list << detail::BorrowedRef(kwargs ? kwargs : Py_None);
+        detail::Load_func("apply_each", detail::get_grid_helpers()).call(apply_args.to_tuple());
+    }
+
+    // Calls the method of the k-th selected cell with the k-th string.
+    void call_each(const std::string& name, const std::vector<std::string>& strings, const KeyWords& keywords)
+    {
+        auto kwargs = detail::get_keywords(keywords);
+        if (!this->is_grid()) {
+            assert(strings.size() <= 1);
+            for (const auto& str : strings) {
+                detail::PyContainer args;
+                args << str;
+                this->call(name, args.to_tuple(), kwargs);
+            }
+            return;
+        }
+        assert(strings.size() <= this->get_selection().size());
+        detail::NewRef args_list = PyList_New(Py_ssize_t(strings.size()));
+        for (std::size_t k = 0; k < strings.size(); ++k) {
+            PyList_SetItem(args_list, Py_ssize_t(k), Py_BuildValue("(s)", strings[k].c_str()));
+        }
+        this->call_each(name, args_list, kwargs);
+    }
+
+    detail::Artist add_line_collection(const detail::NewRef& segments,
+                                       long nlines,
+                                       const LineStyles& styles,
+                                       const KeyWords& keywords)
+    {
+        assert(this->nrows * this->ncols == 1);
+        detail::NewRef collections = PyImport_ImportModule("matplotlib.collections");
+        if (!collections) {
+            throw std::runtime_error("Error loading module matplotlib.collections!");
+        }
+        detail::NewRef line_collection = PyObject_GetAttrString(collections, "LineCollection");
+
+        detail::PyContainer args;
+        args << segments;
+        auto kwargs = detail::get_keywords(keywords);
+        if (!styles.colors.empty()) {
+            assert(long(styles.colors.size()) == 4 * nlines);
+            PyDict_SetItemString(kwargs, "colors", detail::get_pyarray(styles.colors.data(), {nlines, 4}));
+        }
+        if (!styles.linewidths.empty()) {
+            assert(long(styles.linewidths.size()) == nlines);
+            PyDict_SetItemString(kwargs, "linewidths", detail::get_pyarray(styles.linewidths));
+        }
+        detail::NewRef lc_args = args.to_tuple();
+        detail::notify_call(line_collection, lc_args, kwargs);
+        detail::NewRef lc = PyObject_Call(line_collection, lc_args, kwargs);
+        if (!lc) {
+            throw std::runtime_error("Couldn't create LineCollection.");
+        }
+        if (!styles.values.empty()) {
+            assert(long(styles.values.size()) == nlines);
+            detail::Load_func set_array("set_array", lc);
+            detail::PyContainer values;
+            values << detail::get_pyarray(styles.values);
+            set_array.call(values.to_tuple());
+        }
+
+        // autoscale once for all the lines
+        detail::PyContainer collection;
+        collection << detail::BorrowedRef(lc);
+        this->get_func("add_collection").call(collection.to_tuple());
+        this->get_func("autoscale_view").call();
+        return detail::Artist(lc);
+    }
+
+    detail::Artist contour_set(const std::vector<detail::ContourPath>& paths,
+                               const std::vector<double>& levels,
+                               bool filled,
+                               double x0,
+                               double y0,
+                               const KeyWords& keywords)
+    {
+        detail::NewRef contour = PyImport_ImportModule("matplotlib.contour");
+        if (!contour) {
+            throw std::runtime_error("Error loading module matplotlib.contour!");
+        }
+        detail::NewRef contour_set = PyObject_GetAttrString(contour, "ContourSet");
+
+        // one compound path per level, given as allsegs and allkinds with a single entry each
+        std::size_t npoints = 0;
+        for (const auto& path : paths) {
+            npoints += path.codes.size();
+        }
+        detail::NewRef allsegs  = PyList_New(0);
+        detail::NewRef allkinds = PyList_New(0);
+        for (const auto& path : paths) {
+            npy_intp n          = npy_intp(path.codes.size());
+            detail::NewRef segs = PyList_New(0);
+            PyList_Append(segs, detail::get_pyarray(path.vertices.data(), {n, 2}));
+            detail::NewRef kinds = PyList_New(0);
+            PyList_Append(kinds, detail::get_pyarray(path.codes.data(), {n}));
+            PyList_Append(allsegs, segs);
+            PyList_Append(allkinds, kinds);
+        }
+        if (npoints == 0 && !paths.empty()) {
+            // ContourSet needs at least one vertex to compute its limits
+            double origin[2]    = {x0, y0};
+            std::uint8_t moveto = detail::ContourPath::MOVETO;
+            PySequence_SetItem(PyList_GetItem(allsegs, 0), 0, detail::get_pyarray(origin, {1, 2}));
+            PySequence_SetItem(PyList_GetItem(allkinds, 0), 0, detail::get_pyarray(&moveto, {1}));
+        }
+
+        detail::PyContainer args;
+        args << detail::BorrowedRef(this->ax) << detail::get_pyarray(levels) << allsegs << allkinds;
+        auto kwargs = detail::get_keywords(keywords);
+        detail::set_item(kwargs, "filled", PyBool_FromLong(filled));
+        detail::NewRef cs_args = args.to_tuple();
+        detail::notify_call(contour_set, cs_args, kwargs);
+        detail::NewRef cs = PyObject_Call(contour_set, cs_args, kwargs);
+        if (!cs) {
+            throw std::runtime_error("Couldn't create ContourSet.");
+        }
+        return detail::Artist(cs);
+    }
+
+    template <typename Scalar>
+    detail::Image image(const std::string& method,
+                        detail::PyContainer& args,
+                        const Scalar* data,
+                        const std::vector<npy_intp>& shape,
+                        double vmin,
+                        double vmax,
+                        const KeyWords& keywords)
+    {
+        assert(this->nrows * this->ncols == 1);
+        args << detail::get_pyarray_view(data, shape);
+        auto kwargs = detail::get_keywords(keywords);
+        if (!std::isnan(vmin)) {
+            detail::set_item(kwargs, "vmin", PyFloat_FromDouble(vmin));
+        }
+        if (!std::isnan(vmax)) {
+            detail::set_item(kwargs, "vmax", PyFloat_FromDouble(vmax));
+        }
+        auto func = this->get_func(method);
+        func.call(args.to_tuple(), kwargs);
+        return detail::Image(func.res, shape, method == "pcolormesh" ? "set_array" : "set_data");
+    }
+
+    template <typename Matrix>
+    detail::Artist spy_matrix(const Matrix& matrix, const SpyOptions& options, const KeyWords& keywords)
+    {
+        assert(this->nrows * this->ncols == 1);
+        detail::check_matrix(matrix);
+        auto kwargs = detail::get_keywords(keywords);
+        detail::Artist artist;
+        if (options.image) {
+            // at most one pixel per entry
+            auto pixels = this->get_pixels();
+            long w      = std::max(1L, std::min(pixels.first, matrix.ncols));
+            long h      = std::max(1L, std::min(pixels.second, matrix.nrows));
+            auto image  = detail::get_pyarray<float>(nullptr, {h, w});
+            detail::get_density(matrix, w, h, options.precision, options.nthreads,
+                                (float*)PyArray_DATA((PyArrayObject*)(PyObject*)image));
+
+            detail::PyContainer args;
+            args << image;
+            detail::NewRef extent = Py_BuildValue("(dddd)", -0.5, matrix.ncols - 0.5, matrix.nrows - 0.5, -0.5);
+            PyDict_SetItemString(kwargs, "extent", extent);
+            detail::set_item(kwargs, "origin", PyUnicode_FromString("upper"));
+            detail::set_item(kwargs, "interpolation", PyUnicode_FromString("nearest"));
+            detail::set_item(kwargs, "vmin", PyFloat_FromDouble(0.0));
+            if (keywords.find("cmap") == keywords.end()) {
+                detail::set_item(kwargs, "cmap", PyUnicode_FromString("binary"));
+            }
+            auto func = this->get_func("imshow");
+            func.call(args.to_tuple(), kwargs);
+            artist = detail::Image(func.res, {h, w});
+        } else {
+            auto nonzeros = detail::get_nonzeros(matrix, options.precision);
+            detail::PyContainer args;
+            args << detail::get_pyarray(nonzeros.first) << detail::get_pyarray(nonzeros.second) << std::string("s");
+            if (options.markersize > 0) {
+                detail::set_item(kwargs, "markersize", PyFloat_FromDouble(options.markersize));
+            }
+            auto func = this->get_func("plot");
+            func.call(args.to_tuple(), kwargs);
+            artist = detail::Artist(PyList_GetItem(func.res, 0));
+        }
+
+        // the layout of matplotlib's spy: first row on top, column ticks above
+        this->set_xlim(-0.5, matrix.ncols - 0.5);
+        this->set_ylim(matrix.nrows - 0.5, -0.5);
+        this->set({{"aspect", "equal"}});
+        detail::NewRef xaxis = PyObject_GetAttrString(this->ax, "xaxis");
+        detail::Load_func("tick_top", xaxis).call();
+        return artist;
+    }
+
+    template <typename ScalarX, typename ScalarY>
+    std::vector<std::size_t> cull_texts(const std::vector<ScalarX>& x,
+                                        const std::vector<ScalarY>& y,
+                                        const std::vector<std::string>& labels,
+                                        const TextStyles& styles,
+                                        const TextOptions& options,
+                                        const std::string& ha,
+                                        const std::string& va,
+                                        const KeyWords& keywords)
+    {
+        std::size_t n = labels.size();
+        auto xy       = detail::get_pyarray<double>(nullptr, {npy_intp(n), 2});
+        double* data  = (double*)PyArray_DATA((PyArrayObject*)(PyObject*)xy);
+        for (std::size_t k = 0; k < n; ++k) {
+            data[2 * k]     = double(x[k]);
+            data[2 * k + 1] = double(y[k]);
+        }
+        // reading the limits applies a pending autoscale, which changes transData
+        detail::NewRef xlim      = PyObject_CallMethod(this->ax, "get_xlim", nullptr);
+        detail::NewRef ylim      = PyObject_CallMethod(this->ax, "get_ylim", nullptr);
+        detail::NewRef transform = PyObject_GetAttrString(this->ax, "transData");
+        detail::NewRef display   = PyObject_CallMethod(transform, "transform", "O", (PyObject*)xy);
+        detail::NewRef array     = display ? PyArray_FROM_OTF(display, NPY_DOUBLE, NPY_ARRAY_IN_ARRAY) : nullptr;
+        if (!array) {
+            throw std::runtime_error("Couldn't transform the text positions.");
+        }
+        const double* pixels = (const double*)PyArray_DATA((PyArrayObject*)(PyObject*)array);
+
+        // sizes are converted from points to the pixels of the figure
+        detail::NewRef fig     = PyObject_GetAttrString(this->ax, "figure");
+        detail::NewRef dpi     = PyObject_GetAttrString(fig, "dpi");
+        double points          = PyFloat_AsDouble(dpi) / 72.0;
+        detail::NewRef bbox    = PyObject_CallMethod(this->ax, "get_window_extent", nullptr);
+        detail::NewRef extents = PyObject_GetAttrString(bbox, "extents");
+        double bounds[4];
+        for (int i = 0; i < 4; ++i) {
+            detail::NewRef bound = PySequence_GetItem(extents, i);
+            bounds[i]            = PyFloat_AsDouble(bound);
+        }
+        double fontsize = 0;
+        auto it         = keywords.find("fontsize");
+        if (it != keywords.end()) {
+            fontsize = std::strtod(it->second.c_str(), nullptr);
+        }
+        if (fontsize <= 0) {
+            detail::NewRef matplotlib = PyImport_ImportModule("matplotlib");
+            detail::NewRef rcparams   = PyObject_GetAttrString(matplotlib, "rcParams");
+            detail::NewRef size       = PyMapping_GetItemString(rcparams, "font.size");
+            fontsize                  = PyFloat_AsDouble(size);
+        }
+
+        std::vector<std::size_t> kept;
+        detail::TextCuller culler(2 * fontsize * points);
+        double padding = options.padding * points;
+        for (std::size_t k = 0; k < n; ++k) {
+            double px = pixels[2 * k], py = pixels[2 * k + 1];
+            if (!std::isfinite(px) || !std::isfinite(py) || px < bounds[0] || px > bounds[2] || py < bounds[1] ||
+                py > bounds[3]) {
+                continue;
+            }
+            if (!styles.offsets.empty()) {
+                px += styles.offsets[2 * k] * points;
+                py += styles.offsets[2 * k + 1] * points;
+            }
+            double size = (styles.sizes.empty() ? fontsize : styles.sizes[k]) * points;
+            auto box    = detail::get_text_box(px, py, detail::get_length(labels[k]), size, ha, va);
+            if (culler.accept({box.x0 - padding, box.y0 - padding, box.x1 + padding, box.y1 + padding})) {
+                kept.push_back(k);
+            }
+        }
+        return kept;
+    }
+
+    // Size of the axes in pixels at dpi, 0 for the dpi of the figure.
+    std::pair<long, long> get_pixels(double dpi = 0) const
+    {
+        detail::NewRef bbox   = PyObject_CallMethod(this->ax, "get_window_extent", nullptr);
+        detail::NewRef width  = PyObject_GetAttrString(bbox, "width");
+        detail::NewRef height = PyObject_GetAttrString(bbox, "height");
+        double scale          = 1.0;
+        if (dpi > 0) {
+            detail::NewRef fig        = PyObject_GetAttrString(this->ax, "figure");
+            detail::NewRef figure_dpi = PyObject_GetAttrString(fig, "dpi");
+            scale                     = dpi / PyFloat_AsDouble(figure_dpi);
+        }
+        return {std::lround(PyFloat_AsDouble(width) * scale), std::lround(PyFloat_AsDouble(height) * scale)};
+    }
+
+    // scatter of x and y as arrays, with the areas s unless it is empty
+    template <typename ScalarX, typename ScalarY, typename ScalarS>
+    void scatter_arrays(const std::vector<ScalarX>& x,
+                        const std::vector<ScalarY>& y,
+                        const std::vector<ScalarS>& s,
+                        PyObject* kwargs)
+    {
+        assert(this->nrows * this->ncols == 1 && x.size() == y.size() && (s.empty() || s.size() == x.size()));
+        detail::PyContainer args;
+        args << detail::get_pyarray(x) << detail::get_pyarray(y);
+        if (!s.empty())
+            PyDict_SetItemString(kwargs, "s", detail::get_pyarray(s));
+        auto func = this->get_func("scatter");
+        func.call(args.to_tuple(), kwargs);
+    }
+
+    // bar or barh of values at the positions of the categories
+    template <typename Scalar>
+    void categorical(const char* name, const Categories& categories, const std::vector<Scalar>& values,
+                     const KeyWords& keywords)
+    {
+        assert(this->nrows * this->ncols == 1 && categories.size() == values.size());
+        detail::PyContainer args;
+        args << detail::get_pyarray(categories.codes) << detail::get_pyarray(values);
+        auto func = this->get_func(name);
+        func.call(args.to_tuple(), detail::get_keywords(keywords));
+        detail::set_categories(this->ax, categories, std::string(name) == "barh" ? "yaxis" : "xaxis");
+    }
+
+    template <typename ScalarX, typename ScalarY>
+    void rasterize(const ScalarX* x,
+                   const ScalarY* y,
+                   std::size_t n,
+                   bool lines,
+                   const RasterOptions& options,
+                   const KeyWords& keywords)
+    {
+        assert(this->nrows * this->ncols == 1);
+        auto extent = detail::get_extent(x, y, n);
+
+        // one image pixel per device pixel of the axes
+        auto pixels = this->get_pixels(options.dpi);
+        long w = pixels.first, h = pixels.second;
+
+        detail::Rasterizer rasterizer(w, h, extent[0], extent[1], extent[2], extent[3], options.nthreads);
+        w = rasterizer.get_width();
+        h = rasterizer.get_height();
+
+        auto image  = detail::get_pyarray<float>(nullptr, {h, w});
+        float* data = (float*)PyArray_DATA((PyArrayObject*)(PyObject*)image);
+        std::fill(data, data + w * h, 0.0f);
+        if (lines) {
+            rasterizer.polyline(x, y, n, options.antialiased, data);
+        } else {
+            rasterizer.points(x, y, n, options.antialiased, data);
+        }
+        // empty pixels are masked, so they stay transparent
+        std::replace(data, data + w * h, 0.0f, std::numeric_limits<float>::quiet_NaN());
+
+        detail::PyContainer args;
+        args << image;
+        auto kwargs = detail::get_keywords(keywords);
+        detail::PyContainer ext;
+        ext << extent[0] << extent[1] << extent[2] << extent[3];
+        PyDict_SetItemString(kwargs, "extent", ext.to_tuple());
+        detail::set_item(kwargs, "origin", PyUnicode_FromString("lower"));
+        detail::set_item(kwargs, "aspect", PyUnicode_FromString("auto"));
+        detail::set_item(kwargs, "interpolation", PyUnicode_FromString("nearest"));
+        detail::set_item(kwargs, "alpha", PyFloat_FromDouble(options.alpha));
+        if (options.log) {
+            detail::set_item(kwargs, "norm", PyUnicode_FromString("log"));
+        }
+        // imshow replaces the view limits by the extent, keep the other artists of the axes in view
+        detail::NewRef has_data = PyObject_CallMethod(this->ax, "has_data", nullptr);
+        bool had_data           = PyObject_IsTrue(has_data);
+        detail::NewRef xlim     = PyObject_CallMethod(this->ax, "get_xlim", nullptr);
+        detail::NewRef ylim     = PyObject_CallMethod(this->ax, "get_ylim", nullptr);
+
+        auto func = this->get_func("imshow");
+        func.call(args.to_tuple(), kwargs);
+
+        if (had_data) {
+            this->set_xlim(std::min(extent[0], PyFloat_AsDouble(PyTuple_GetItem(xlim, 0))),
+                           std::max(extent[1], PyFloat_AsDouble(PyTuple_GetItem(xlim, 1))));
+            this->set_ylim(std::min(extent[2], PyFloat_AsDouble(PyTuple_GetItem(ylim, 0))),
+                           std::max(extent[3], PyFloat_AsDouble(PyTuple_GetItem(ylim, 1))));
+        }
+    }
+
 private:
     PyObject* ax;
     long nrows;
     long ncols;
+    std::shared_ptr<std::vector<Axes>> cells;  // handles of the cells of a grid, shared by all copies
+    std::vector<long> selection;               // cells addressed by the grid operations, empty: all
 };
 }  // namespace detail
 }  // namespace matplotlibcpp
@@ -0,0 +1,253 @@
+#ifndef __PLT_BAND_HPP__
+#define __PLT_BAND_HPP__
+
+#include <algorithm>
+#include <cmath>
+#include "utility.hpp"
+
+namespace matplotlibcpp
+{
+/** Options of band plots.
+ * The x range is cut into buckets, the band of a bucket is mean +/- nsigma standard deviations,
+ * or the lower and upper quantiles around the median when both are set.
+ */
+struct BandOptions
+{
+    explicit BandOptions(long buckets = 256, double nsigma = 1.0, double alpha = 0.3, unsigned nthreads = 0)
+        : buckets(buckets), nsigma(nsigma), lower(NAN), upper(NAN), alpha(alpha), nthreads(nthreads)
+    {
+    }
+
+    bool quantiles() const
+    {
+        return !std::isnan(this->lower) && !std::isnan(this->upper);
+    }
+
+    long buckets;
+    double nsigma;
+    double lower;       // e.g. 0.05, NAN for mean +/- nsigma sigma
+    double upper;       // e.g. 0.95
+    double alpha;       // alpha of the band
+    unsigned nthreads;  // 0: std::thread::hardware_concurrency()
+};
+
+namespace detail
+{
+/** P-square estimator of the quantile p (Jain and Chlamtac), constant memory for any number of samples. */
+class P2Quantile
+{
+public:
+    explicit P2Quantile(double p = 0.5) : p(p), n(0) {}
+
+    void add(double x)
+    {
+        if (this->n < 5) {
+            this->q[this->n++] = x;
+            if (this->n == 5) {
+                std::sort(this->q, this->q + 5);
+                const double desired[5] = {1, 1 + 2 * p, 1 + 4 * p, 3 + 2 * p, 5};
+                const double step[5]    = {0, p / 2, p, (1 + p) / 2, 1};
+                for (int i = 0; i < 5; ++i) {
+                    this->pos[i]     = i + 1;
+                    this->desired[i] = desired[i];
+                    this->step[i]    = step[i];
+                }
+            }
+            return;
+        }
+
+        int k;
+        if (x < this->q[0]) {
+            this->q[0] = x;
+            k          = 0;
+        } else if (x >= this->q[4]) {
+            this->q[4] = x;
+            k          = 3;
+        } else {
+            k = int(std::upper_bound(this->q, this->q + 5, x) - this->q) - 1;
+        }
+        for (int i = k + 1; i < 5; ++i) {
+            this->pos[i] += 1;
+        }
+        for (int i = 0; i < 5; ++i) {
+            this->desired[i] += this->step[i];
+        }
+        // move the middle markers towards their desired positions
+        for (int i = 1; i < 4; ++i) {
+            double d = this->desired[i] - this->pos[i];
+            if ((d >= 1 && this->pos[i + 1] - this->pos[i] > 1) || (d <= -1 && this->pos[i - 1] - this->pos[i] < -1)) {
+                int s     = d > 0 ? 1 : -1;
+                double qp = this->parabolic(i, s);
+                if (this->q[i - 1] < qp && qp < this->q[i + 1]) {
+                    this->q[i] = qp;
+                } else {
+                    this->q[i] += s * (this->q[i + s] - this->q[i]) / (this->pos[i + s] - this->pos[i]);
+                }
+                this->pos[i] += s;
+            }
+        }
+        ++this->n;
+    }
+
+    double value() const
+    {
+        if (this->n >= 5) {
+            return this->q[2];
+        }
+        if (this->n == 0) {
+            return NAN;
+        }
+        // exact for the first samples
+        double sorted[5];
+        std::copy(this->q, this->q + this->n, sorted);
+        std::sort(sorted, sorted + this->n);
+        double h = (this->n - 1) * this->p;
+        long lo  = long(h);
+        return lo + 1 < this->n ? sorted[lo] + (h - lo) * (sorted[lo + 1] - sorted[lo]) : sorted[lo];
+    }
+
+private:
+    double parabolic(int i, int s) const
+    {
+        const double* n = this->pos;
+        return this->q[i] + s / (n[i + 1] - n[i - 1]) *
+                                ((n[i] - n[i - 1] + s) * (this->q[i + 1] - this->q[i]) / (n[i + 1] - n[i]) +
+                                 (n[i + 1] - n[i] - s) * (this->q[i] - this->q[i - 1]) / (n[i] - n[i - 1]));
+    }
+
+    double p;
+    long n;
+    double q[5];        // marker heights
+    double pos[5];      // marker positions
+    double desired[5];  // desired marker positions
+    double step[5];     // increments of the desired positions
+};
+
+/** Running statistics of one bucket, Welford's mean and variance and optional quantile estimators. */
+struct BandBucket
+{
+    BandBucket(double lower = 0.5, double upper = 0.5) : n(0), mean(0), m2(0), lower(lower), median(0.5), upper(upper)
+    {
+    }
+
+    void add(double y, bool quantiles)
+    {
+        ++this->n;
+        double delta = y - this->mean;
+        this->mean += delta / this->n;
+        this->m2 += delta * (y - this->mean);
+        if (quantiles) {
+            this->lower.add(y);
+            this->median.add(y);
+            this->upper.add(y);
+        }
+    }
+
+    double sigma() const
+    {
+        return this->n > 1 ? std::sqrt(this->m2 / (this->n - 1)) : 0.0;
+    }
+
+    long n;
+    double mean;
+    double m2;
+    P2Quantile lower, median, upper;
+};
+}  // namespace detail
+
+/** Streaming aggregation of (x, y) samples into the buckets of a band plot.
+ * Memory is O(buckets) whatever the number of samples. Chunks are aggregated in parallel,
+ * every thread owns a range of buckets and keeps the order of its samples.
+ */
+class BandAggregator
+{
+public:
+    BandAggregator(double xmin, double xmax, const BandOptions& options = BandOptions())
+        : xmin(xmin),
+          xmax(xmax),
+          options(options),
+          buckets(std::max(options.buckets, 1L),
+                  detail::BandBucket(options.quantiles() ? options.lower : 0.5,
+                                     options.quantiles() ? options.upper : 0.5))
+    {
+        if (!(xmax > xmin)) {
+            throw std::runtime_error("BandAggregator: xmax must be greater than xmin");
+        }
+    }
+
+    /**
+     * @brief Adds a chunk of samples, samples outside [xmin, xmax] or non-finite are dropped.
+     */
+    template <typename ScalarX, typename ScalarY>
+    void add(const ScalarX* x, const ScalarY* y, std::size_t n)
+    {
+        long nbuckets  = long(this->buckets.size());
+        double scale   = nbuckets / (this->xmax - this->xmin);
+        bool quantiles = this->options.quantiles();
+        unsigned nthreads =
+            this->options.nthreads ? this->options.nthreads : std::max(std::thread::hardware_concurrency(), 1u);
+        // small chunks don't pay for the threads
+        std::size_t ntasks = std::min<std::size_t>({nthreads, std::size_t(nbuckets), n / 65536 + 1});
+        detail::parallel_for(ntasks, nthreads, [&](std::size_t t) {
+            long first = long(nbuckets * t / ntasks), last = long(nbuckets * (t + 1) / ntasks);
+            for (std::size_t i = 0; i < n; ++i) {
+                double xi = double(x[i]), yi = double(y[i]);
+                if (!(xi >= this->xmin && xi <= this->xmax) || !std::isfinite(yi)) {
+                    continue;
+                }
+                long b = std::min(long((xi - this->xmin) * scale), nbuckets - 1);
+                if (b >= first && b < last) {
+                    this->buckets[b].add(yi, quantiles);
+                }
+            }
+        });
+    }
+
+    template <typename ScalarX, typename ScalarY>
+    void add(const std::vector<ScalarX>& x, const std::vector<ScalarY>& y)
+    {
+        assert(x.size() == y.size());
+        this->add(x.data(), y.data(), x.size());
+    }
+
+    /**
+     * @brief Bucket centers with the center line and the envelope of the non-empty buckets.
+     */
+    void get_band(std::vector<double>& x,
+                  std::vector<double>& center,
+                  std::vector<double>& lower,
+                  std::vector<double>& upper) const
+    {
+        double width = (this->xmax - this->xmin) / this->buckets.size();
+        for (std::size_t b = 0; b < this->buckets.size(); ++b) {
+            const auto& bucket = this->buckets[b];
+            if (bucket.n == 0) {
+                continue;
+            }
+            x.push_back(this->xmin + (b + 0.5) * width);
+            if (this->options.quantiles()) {
+                center.push_back(bucket.median.value());
+                lower.push_back(bucket.lower.value());
+                upper.push_back(bucket.upper.value());
+            } else {
+                center.push_back(bucket.mean);
+                lower.push_back(bucket.mean - this->options.nsigma * bucket.sigma());
+                upper.push_back(bucket.mean + this->options.nsigma * bucket.sigma());
+            }
+        }
+    }
+
+    const BandOptions& get_options() const
+    {
+        return this->options;
+    }
+
+private:
+    double xmin;
+    double xmax;
+    BandOptions options;
+    std::vector<detail::BandBucket> buckets;
+};
+}  // namespace matplotlibcpp
+
+#endif  // !__PLT_BAND_HPP__
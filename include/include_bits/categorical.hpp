@@ -0,0 +1,83 @@
+#ifndef __PLT_CATEGORICAL_HPP__
+#define __PLT_CATEGORICAL_HPP__
+
+#include <unordered_map>
+#include "utility.hpp"
+
+namespace matplotlibcpp
+{
+/** Categorical data, dictionary-encoded as codes into uniques.
+ * Category k is drawn at position k and uniques[k] becomes its tick label, the labels are
+ * sent once as a numpy unicode array. Built from strings, every distinct string is stored
+ * once, in order of first appearance. Pass the same Categories to all series of an axis
+ * so that they share positions.
+ */
+struct Categories
+{
+    explicit Categories(const std::vector<std::string>& values) : codes(values.size())
+    {
+        std::unordered_map<std::string, long> index;
+        for (std::size_t k = 0; k < values.size(); ++k) {
+            auto it = index.find(values[k]);
+            if (it == index.end()) {
+                it = index.emplace(values[k], long(this->uniques.size())).first;
+                this->uniques.push_back(values[k]);
+            }
+            this->codes[k] = it->second;
+        }
+    }
+
+    Categories(const std::vector<long>& codes, const std::vector<std::string>& uniques)
+        : codes(codes), uniques(uniques)
+    {
+    }
+
+    std::size_t size() const
+    {
+        return this->codes.size();
+    }
+
+    std::vector<long> codes;
+    std::vector<std::string> uniques;
+};
+
+namespace detail
+{
+/**
+ * @brief Puts the category labels on the ticks of an axis, axis_name is "xaxis" or "yaxis".
+ *
+ * A FixedLocator and FixedFormatter are installed directly: set_xticks would create one Tick
+ * per category up front, which costs more than the plot itself for many categories.
+ */
+inline void set_categories(PyObject* ax, const Categories& categories, const char* axis_name)
+{
+    NewRef ticker = PyImport_ImportModule("matplotlib.ticker");
+    if (!ticker) {
+        throw std::runtime_error("Error loading module matplotlib.ticker!");
+    }
+    std::vector<long> ticks(categories.uniques.size());
+    for (std::size_t k = 0; k < ticks.size(); ++k) {
+        ticks[k] = long(k);
+    }
+    NewRef axis = PyObject_GetAttrString(ax, axis_name);
+
+    PyContainer locator_args;
+    locator_args << get_pyarray(ticks);
+    Load_func locator("FixedLocator", ticker);
+    locator.call(locator_args.to_tuple());
+    PyContainer args;
+    args << BorrowedRef(locator.res);
+    Load_func("set_major_locator", axis).call(args.to_tuple());
+
+    PyContainer formatter_args;
+    formatter_args << get_unicode_array(categories.uniques);
+    Load_func formatter("FixedFormatter", ticker);
+    formatter.call(formatter_args.to_tuple());
+    PyContainer set_args;
+    set_args << BorrowedRef(formatter.res);
+    Load_func("set_major_formatter", axis).call(set_args.to_tuple());
+}
+}  // namespace detail
+}  // namespace matplotlibcpp
+
+#endif  // !__PLT_CATEGORICAL_HPP__
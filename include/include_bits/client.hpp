@@ -0,0 +1,471 @@
+#ifndef __PLT_CLIENT_HPP__
+#define __PLT_CLIENT_HPP__
+
+#include <cassert>
+#include <map>
+#include "ipc.hpp"
+
+namespace matplotlibcpp
+{
+using KeyWords = std::map<std::string, std::string>;
+
+/** Python object kept by the plot server, 0 is the pyplot module. */
+struct RemoteObject
+{
+    explicit RemoteObject(std::uint64_t handle = 0) : handle(handle) {}
+
+    std::uint64_t handle;
+};
+
+/** Result of a remote call: bool, long and double results are in number, strings in text,
+ * tuples and lists in items, kept results in object, anything else is None.
+ */
+struct RemoteValue
+{
+    RemoteValue() : type(detail::WIRE_NONE), number(0) {}
+
+    std::uint8_t type;  // detail::WireType
+    double number;
+    std::string text;
+    RemoteObject object;
+    std::vector<RemoteValue> items;
+};
+
+/** A call of a method of a remote object, or of a pyplot function.
+ * Arguments are serialized as they are added, vectors become ndarrays.
+ */
+class RemoteCall
+{
+public:
+    explicit RemoteCall(const std::string& method, const RemoteObject& target = RemoteObject()) : count(0)
+    {
+        this->message.put(target.handle);
+        this->message.put_string(method);
+        this->keep_pos = this->message.bytes.size();
+        this->message.put(std::uint8_t(0));
+        this->count_pos = this->message.bytes.size();
+        this->message.put(std::uint32_t(0));
+    }
+
+    template <typename T>
+    RemoteCall& operator<<(const T& value)
+    {
+        return this->arg("", value);
+    }
+
+    /**
+     * @brief Adds a keyword argument, or a positional one when key is empty.
+     */
+    template <typename T>
+    RemoteCall& arg(const std::string& key, const T& value)
+    {
+        this->message.put_string(key);
+        this->put(value);
+        return this->added();
+    }
+
+    /**
+     * @brief Adds an ndarray of the given shape, row-major.
+     */
+    template <typename T>
+    RemoteCall& array(const T* data, const std::vector<std::int64_t>& shape, const std::string& key = "")
+    {
+        this->message.put_string(key);
+        this->message.put_array(data, shape);
+        return this->added();
+    }
+
+    RemoteCall& keywords(const KeyWords& keywords)
+    {
+        for (const auto& item : keywords) {
+            this->arg(item.first, item.second);
+        }
+        return *this;
+    }
+
+    // The server stores the result and replies with its handle.
+    void set_keep(bool keep)
+    {
+        this->message.bytes[this->keep_pos] = char(keep);
+    }
+
+    const detail::WireWriter& get_message() const
+    {
+        return this->message;
+    }
+
+private:
+    RemoteCall& added()
+    {
+        ++this->count;
+        std::memcpy(&this->message.bytes[this->count_pos], &this->count, sizeof(this->count));
+        return *this;
+    }
+
+    void put(bool value)
+    {
+        this->message.put_value(value);
+    }
+
+    void put(int value)
+    {
+        this->message.put_value(value);
+    }
+
+    void put(long value)
+    {
+        this->message.put_value(value);
+    }
+
+    void put(double value)
+    {
+        this->message.put_value(value);
+    }
+
+    void put(const std::string& value)
+    {
+        this->message.put_value(value);
+    }
+
+    void put(const char* value)
+    {
+        this->message.put_value(value);
+    }
+
+    void put(const std::vector<std::string>& values)
+    {
+        this->message.put_value(values);
+    }
+
+    void put(const RemoteObject& object)
+    {
+        this->message.put_handle(object.handle);
+    }
+
+    void put(const std::vector<double>& v)
+    {
+        this->message.put_array(v);
+    }
+
+    void put(const std::vector<float>& v)
+    {
+        this->message.put_array(v);
+    }
+
+    void put(const std::vector<std::int64_t>& v)
+    {
+        this->message.put_array(v);
+    }
+
+    void put(const std::vector<std::int32_t>& v)
+    {
+        this->message.put_array(v);
+    }
+
+    void put(const std::vector<std::uint8_t>& v)
+    {
+        this->message.put_array(v);
+    }
+
+    // other element types are sent as doubles
+    template <typename T>
+    void put(const std::vector<T>& v)
+    {
+        this->message.put_array(std::vector<double>(v.begin(), v.end()));
+    }
+
+    detail::WireWriter message;
+    std::size_t keep_pos;
+    std::size_t count_pos;
+    std::uint32_t count;
+};
+
+/** Client of matplotlibcpp::PlotServer, with the plotting API of PLT.
+ * It does not embed Python, so a process only pays for connecting to the socket.
+ * Errors of the server are thrown as std::runtime_error.
+ */
+class PlotClient
+{
+public:
+    explicit PlotClient(const std::string& path = detail::get_socket_path())
+    {
+        this->sock = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (this->sock < 0) {
+            throw std::runtime_error(std::string("socket: ") + std::strerror(errno));
+        }
+        sockaddr_un address = detail::get_socket_address(path);
+        if (::connect(this->sock, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+            std::string error = std::strerror(errno);
+            ::close(this->sock);
+            throw std::runtime_error("Couldn't connect to the plot server at " + path + ": " + error);
+        }
+    }
+
+    PlotClient(const PlotClient&) = delete;
+    PlotClient& operator=(const PlotClient&) = delete;
+
+    ~PlotClient()
+    {
+        ::close(this->sock);
+    }
+
+    /**
+     * @brief Runs the call on the server and returns its result.
+     */
+    RemoteValue invoke(const RemoteCall& call)
+    {
+        detail::send_frame(this->sock, call.get_message());
+        std::vector<char> bytes;
+        std::vector<int> fds;
+        if (!detail::recv_frame(this->sock, bytes, fds)) {
+            throw std::runtime_error("The plot server closed the connection.");
+        }
+        detail::WireReader reader(bytes);
+        bool ok           = reader.get<std::uint8_t>();
+        std::string error = reader.get_string();
+        if (!ok) {
+            throw std::runtime_error(error);
+        }
+        return this->get_value(reader);
+    }
+
+    /**
+     * @brief Runs the call on the server, which keeps the result for later calls.
+     */
+    RemoteObject keep(RemoteCall& call)
+    {
+        call.set_keep(true);
+        RemoteValue value = this->invoke(call);
+        call.set_keep(false);
+        return value.object;
+    }
+
+    /**
+     * @brief Releases an object kept by the server, all of them are released on disconnection.
+     */
+    void release(const RemoteObject& object)
+    {
+        this->invoke(RemoteCall("__release__", object));
+    }
+
+    template <typename ScalarX = double, typename ScalarY = double>
+    void plot(const std::vector<ScalarX>& x,
+              const std::vector<ScalarY>& y,
+              const std::string& format = "",
+              const KeyWords& keywords  = {})
+    {
+        assert(x.size() == y.size());
+        RemoteCall call("plot");
+        call << x << y << format;
+        this->invoke(call.keywords(keywords));
+    }
+
+    template <typename Scalar = double>
+    void plot(const std::vector<Scalar>& y, const std::string& format = "", const KeyWords& keywords = {})
+    {
+        RemoteCall call("plot");
+        call << y << format;
+        this->invoke(call.keywords(keywords));
+    }
+
+    template <typename ScalarX = double, typename ScalarY = double>
+    void scatter(const std::vector<ScalarX>& x,
+                 const std::vector<ScalarY>& y,
+                 const double s           = 1.0,
+                 const KeyWords& keywords = {})
+    {
+        assert(x.size() == y.size());
+        RemoteCall call("scatter");
+        call << x << y;
+        call.keywords(keywords).arg("s", s);
+        this->invoke(call);
+    }
+
+    template <typename Scalar = double>
+    void bar(const std::vector<Scalar>& x, const std::vector<Scalar>& y, const KeyWords& keywords = {})
+    {
+        RemoteCall call("bar");
+        call << x << y;
+        this->invoke(call.keywords(keywords));
+    }
+
+    template <typename Scalar = double>
+    void hist(const std::vector<Scalar>& y, long bins = 10, const KeyWords& keywords = {})
+    {
+        RemoteCall call("hist");
+        call << y;
+        call.keywords(keywords).arg("bins", bins);
+        this->invoke(call);
+    }
+
+    template <typename ScalarX = double, typename ScalarY1 = double, typename ScalarY2 = double>
+    void fill_between(const std::vector<ScalarX>& x,
+                      const std::vector<ScalarY1>& y1,
+                      const std::vector<ScalarY2>& y2,
+                      const KeyWords& keywords = {})
+    {
+        RemoteCall call("fill_between");
+        call << x << y1 << y2;
+        this->invoke(call.keywords(keywords));
+    }
+
+    /**
+     * @brief imshow of a rows x cols image, row-major.
+     */
+    template <typename Scalar>
+    RemoteObject imshow(const Scalar* data, long rows, long cols, const KeyWords& keywords = {})
+    {
+        RemoteCall call("imshow");
+        call.array(data, {rows, cols}).keywords(keywords);
+        return this->keep(call);
+    }
+
+    void colorbar(const RemoteObject& mappable, const KeyWords& keywords = {})
+    {
+        RemoteCall call("colorbar");
+        call << mappable;
+        this->invoke(call.keywords(keywords));
+    }
+
+    long figure(long number = -1)
+    {
+        RemoteCall call("figure");
+        if (number != -1) {
+            call << number;
+        }
+        RemoteObject fig = this->keep(call);
+        RemoteCall attr("__getattribute__", fig);
+        RemoteValue num = this->invoke(attr << "number");
+        this->release(fig);
+        return long(num.number);
+    }
+
+    void figure_size(const std::vector<double>& figsize, long dpi = 100)
+    {
+        RemoteCall call("figure");
+        call.arg("figsize", figsize).arg("dpi", dpi);
+        this->invoke(call);
+    }
+
+    RemoteObject gca()
+    {
+        RemoteCall call("gca");
+        return this->keep(call);
+    }
+
+    void subplot(long nrows, long ncols, long plot_number)
+    {
+        RemoteCall call("subplot");
+        call << nrows << ncols << plot_number;
+        this->invoke(call);
+    }
+
+    void title(const std::string& titlestr, const KeyWords& keywords = {})
+    {
+        RemoteCall call("title");
+        call << titlestr;
+        this->invoke(call.keywords(keywords));
+    }
+
+    void xlabel(const std::string& str, const KeyWords& keywords = {})
+    {
+        RemoteCall call("xlabel");
+        call << str;
+        this->invoke(call.keywords(keywords));
+    }
+
+    void ylabel(const std::string& str, const KeyWords& keywords = {})
+    {
+        RemoteCall call("ylabel");
+        call << str;
+        this->invoke(call.keywords(keywords));
+    }
+
+    void legend(const KeyWords& keywords = {})
+    {
+        RemoteCall call("legend");
+        this->invoke(call.keywords(keywords));
+    }
+
+    void grid(bool flag)
+    {
+        RemoteCall call("grid");
+        call << flag;
+        this->invoke(call);
+    }
+
+    void xlim(double left, double right)
+    {
+        RemoteCall call("xlim");
+        call << left << right;
+        this->invoke(call);
+    }
+
+    void ylim(double left, double right)
+    {
+        RemoteCall call("ylim");
+        call << left << right;
+        this->invoke(call);
+    }
+
+    void tight_layout()
+    {
+        this->invoke(RemoteCall("tight_layout"));
+    }
+
+    void savefig(const std::string& filename, long dpi = 100, const std::string format = "")
+    {
+        RemoteCall call("savefig");
+        call << filename;
+        call.arg("dpi", dpi);
+        if (!format.empty()) {
+            call.arg("format", format);
+        }
+        this->invoke(call);
+    }
+
+    void close()
+    {
+        this->invoke(RemoteCall("close"));
+    }
+
+    void clf()
+    {
+        this->invoke(RemoteCall("clf"));
+    }
+
+private:
+    RemoteValue get_value(detail::WireReader& reader)
+    {
+        RemoteValue value;
+        value.type = reader.get<std::uint8_t>();
+        switch (value.type) {
+            case detail::WIRE_BOOL:
+                value.number = reader.get<std::uint8_t>();
+                break;
+            case detail::WIRE_LONG:
+                value.number = double(reader.get<std::int64_t>());
+                break;
+            case detail::WIRE_DOUBLE:
+                value.number = reader.get<double>();
+                break;
+            case detail::WIRE_STRING:
+                value.text = reader.get_string();
+                break;
+            case detail::WIRE_HANDLE:
+                value.object = RemoteObject(reader.get<std::uint64_t>());
+                break;
+            case detail::WIRE_LIST:
+                for (std::uint32_t n = reader.get<std::uint32_t>(); n > 0; --n) {
+                    value.items.push_back(this->get_value(reader));
+                }
+                break;
+        }
+        return value;
+    }
+
+    int sock;
+};
+}  // namespace matplotlibcpp
+
+#endif  // !__PLT_CLIENT_HPP__
@@ -0,0 +1,70 @@
+#ifndef __PLT_COLLECTIONS_HPP__
+#define __PLT_COLLECTIONS_HPP__
+
+#include "utility.hpp"
+
+namespace matplotlibcpp
+{
+/** Per-line style of plot_many / line_collection.
+ * Empty vectors fall back to the keywords, otherwise they have one entry per line
+ * (four for colors).
+ */
+struct LineStyles
+{
+    std::vector<double> values;      // colormapped through the cmap keyword
+    std::vector<double> colors;      // RGBA in [0, 1], 4 per line
+    std::vector<double> linewidths;  // in points
+};
+
+namespace detail
+{
+/** Segments of nlines lines sharing x, y is row-major nlines x x.size().
+ * The result is a single (nlines, npoints, 2) ndarray.
+ */
+template <typename ScalarX, typename ScalarY>
+NewRef get_segments(const std::vector<ScalarX>& x, const ScalarY* y, long nlines)
+{
+    npy_intp npoints = npy_intp(x.size());
+    auto segments    = get_pyarray<double>(nullptr, {nlines, npoints, 2});
+    double* data     = (double*)PyArray_DATA((PyArrayObject*)(PyObject*)segments);
+    for (npy_intp i = 0; i < nlines; ++i) {
+        const ScalarY* yi = y + i * npoints;
+        double* seg       = data + 2 * i * npoints;
+        for (npy_intp j = 0; j < npoints; ++j) {
+            seg[2 * j]     = double(x[j]);
+            seg[2 * j + 1] = double(yi[j]);
+        }
+    }
+    return segments;
+}
+
+/** Segments of ragged lines, line i is made of the points offsets[i] to offsets[i + 1].
+ * All points are stored in one (npoints, 2) ndarray, the segments are views on it.
+ */
+template <typename ScalarX, typename ScalarY>
+NewRef get_segments(const std::vector<std::size_t>& offsets, const ScalarX* x, const ScalarY* y)
+{
+    assert(!offsets.empty());
+    npy_intp npoints = npy_intp(offsets.back());
+    auto points      = get_pyarray<double>(nullptr, {npoints, 2});
+    double* data     = (double*)PyArray_DATA((PyArrayObject*)(PyObject*)points);
+    for (npy_intp j = 0; j < npoints; ++j) {
+        data[2 * j]     = double(x[j]);
+        data[2 * j + 1] = double(y[j]);
+    }
+
+    PyObject* segments = PyList_New(offsets.size() - 1);
+    for (std::size_t i = 0; i + 1 < offsets.size(); ++i) {
+        npy_intp dims[2] = {npy_intp(offsets[i + 1] - offsets[i]), 2};
+        PyObject* view   = PyArray_New(&PyArray_Type, 2, dims, NPY_DOUBLE, nullptr, data + 2 * offsets[i], 0,
+                                     NPY_ARRAY_CARRAY, nullptr);
+        Py_INCREF(points);
+        PyArray_SetBaseObject((PyArrayObject*)view, points);
+        PyList_SetItem(segments, i, view);
+    }
+    return segments;
+}
+}  // namespace detail
+}  // namespace matplotlibcpp
+
+#endif  // !__PLT_COLLECTIONS_HPP__
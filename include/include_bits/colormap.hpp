@@ -0,0 +1,170 @@
+#ifndef __PLT_COLORMAP_HPP__
+#define __PLT_COLORMAP_HPP__
+
+#include <cmath>
+#include <cstring>
+#include "artist.hpp"
+
+namespace matplotlibcpp
+{
+/** A matplotlib colormap applied in C++, for frames streamed into an RGBA8 image.
+ * The lookup table of the colormap, with its under, over and bad colors, is fetched once, a
+ * frame is then normalized and colored without any python call:
+ *
+ *     ColorMap colormap("inferno", 20.0, 40.0);
+ *     auto image = plt.imshow(rgba.data(), rows, cols, 4);
+ *     plt.colorbar(colormap);
+ *     // per frame
+ *     colormap.apply(frame, rows, cols, rgba.data());
+ *     image.set_data(rgba.data());
+ *
+ * Values are binned like matplotlib's Normalize or LogNorm followed by the colormap, in single
+ * precision. Row blocks are colored on nthreads threads (0: std::thread::hardware_concurrency()).
+ */
+class ColorMap
+{
+public:
+    ColorMap(const std::string& name, double vmin, double vmax, bool log = false, unsigned nthreads = 0)
+        : log(log), nthreads(nthreads)
+    {
+        detail::NewRef matplotlib = PyImport_ImportModule("matplotlib");
+        detail::NewRef colors     = PyImport_ImportModule("matplotlib.colors");
+        detail::NewRef cm         = PyImport_ImportModule("matplotlib.cm");
+        if (!matplotlib || !colors || !cm) {
+            throw std::runtime_error("Error loading module matplotlib.cm!");
+        }
+        detail::NewRef registry = PyObject_GetAttrString(matplotlib, "colormaps");
+        detail::NewRef key      = PyUnicode_FromString(name.c_str());
+        detail::NewRef cmap     = PyObject_GetItem(registry, key);
+        if (!cmap) {
+            throw std::runtime_error("Unknown colormap: " + name);
+        }
+        this->load_lut(cmap);
+
+        detail::PyContainer norm_args;
+        norm_args << vmin << vmax;
+        detail::Load_func norm(log ? "LogNorm" : "Normalize", colors);
+        norm.call(norm_args.to_tuple());
+        detail::NewRef kwargs = PyDict_New();
+        PyDict_SetItemString(kwargs, "norm", norm.res);
+        PyDict_SetItemString(kwargs, "cmap", cmap);
+        detail::Load_func mappable("ScalarMappable", cm);
+        mappable.call(nullptr, kwargs);
+        this->mappable = detail::Artist(mappable.res);
+        this->set_limits(vmin, vmax);
+    }
+
+    /**
+     * @brief Colors the rows x cols field data into rgba, 4 bytes per value.
+     */
+    template <typename Scalar>
+    void apply(const Scalar* data, long rows, long cols, std::uint8_t* rgba) const
+    {
+        const long block   = 32;
+        std::size_t blocks = std::size_t((rows + block - 1) / block);
+        detail::parallel_for(blocks, this->nthreads, [&](std::size_t b) {
+            long begin = long(b) * block, end = std::min(rows, begin + block);
+            std::size_t offset = std::size_t(begin) * cols, n = std::size_t(end - begin) * cols;
+            if (this->log) {
+                this->apply_block<true>(data + offset, n, rgba + 4 * offset);
+            } else {
+                this->apply_block<false>(data + offset, n, rgba + 4 * offset);
+            }
+        });
+    }
+
+    /**
+     * @brief Changes the range of the norm, for the following frames and for the colorbar.
+     */
+    void set_clim(double vmin, double vmax)
+    {
+        this->set_limits(vmin, vmax);
+        detail::PyContainer args;
+        args << vmin << vmax;
+        detail::Load_func("set_clim", this->mappable.get_artist()).call(args.to_tuple());
+    }
+
+    /**
+     * @brief A ScalarMappable with the colormap and norm, for colorbar.
+     */
+    const detail::Artist& get_mappable() const
+    {
+        return this->mappable;
+    }
+
+private:
+    // the N colors of the colormap followed by its under, over and bad colors, as RGBA8
+    void load_lut(PyObject* cmap)
+    {
+        detail::NewRef size = PyObject_GetAttrString(cmap, "N");
+        this->size          = size ? long(PyLong_AsLong(size)) : 0;
+        if (this->size <= 0) {
+            throw std::runtime_error("Invalid colormap size");
+        }
+        std::vector<double> x(this->size + 3);
+        for (long k = 0; k < this->size; ++k) {
+            x[k] = (k + 0.5) / this->size;
+        }
+        x[this->size]     = -1.0;
+        x[this->size + 1] = 2.0;
+        x[this->size + 2] = NAN;
+
+        detail::PyContainer args;
+        args << detail::get_pyarray(x);
+        detail::NewRef kwargs = PyDict_New();
+        PyDict_SetItemString(kwargs, "bytes", Py_True);
+        detail::NewRef args_tuple = args.to_tuple();
+        detail::NewRef colors     = PyObject_Call(cmap, args_tuple, kwargs);
+        detail::NewRef contiguous = colors ? PyArray_FROMANY(colors, NPY_UBYTE, 2, 2, NPY_ARRAY_C_CONTIGUOUS) : nullptr;
+        if (!contiguous) {
+            throw std::runtime_error("Couldn't read the colors of the colormap");
+        }
+        this->lut.resize(x.size());
+        std::memcpy(this->lut.data(), PyArray_DATA((PyArrayObject*)(PyObject*)contiguous),
+                    this->lut.size() * sizeof(std::uint32_t));
+    }
+
+    void set_limits(double vmin, double vmax)
+    {
+        if (this->log) {
+            if (vmin <= 0 || vmax <= 0) {
+                throw std::runtime_error("ColorMap: vmin and vmax of a logarithmic norm must be positive");
+            }
+            vmin = std::log(vmin);
+            vmax = std::log(vmax);
+        }
+        this->vmin = float(vmin);
+        // a norm of zero width maps everything to the first color, like Normalize
+        this->scale = vmax > vmin ? float(this->size / (vmax - vmin)) : 0.0f;
+    }
+
+    template <bool Log, typename Scalar>
+    void apply_block(const Scalar* data, std::size_t n, std::uint8_t* rgba) const
+    {
+        const std::uint32_t* lut = this->lut.data();
+        const float last = float(this->size), vmin = this->vmin, scale = this->scale;
+        const long under = this->size, over = this->size + 1, bad = this->size + 2;
+        for (std::size_t k = 0; k < n; ++k) {
+            float v = float(data[k]);
+            if (Log) {
+                // nonpositive and infinite values are masked by LogNorm
+                v = v > 0 && v < INFINITY ? std::log(v) : NAN;
+            }
+            float t = (v - vmin) * scale;
+            long index = t < 0 ? under : t > last ? over : t == last ? this->size - 1 : long(t);
+            index      = std::isnan(t) ? bad : index;
+            std::memcpy(rgba + 4 * k, lut + index, sizeof(std::uint32_t));
+        }
+    }
+
+    std::vector<std::uint32_t> lut;
+    long size;
+    float vmin;
+    float scale;
+    bool log;
+    unsigned nthreads;
+    detail::Artist mappable;
+};
+}  // namespace matplotlibcpp
+
+#endif  // !__PLT_COLORMAP_HPP__
@@ -0,0 +1,387 @@
+#ifndef __PLT_CONTOUR_HPP__
+#define __PLT_CONTOUR_HPP__
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+#include <utility>
+#include "utility.hpp"
+
+namespace matplotlibcpp
+{
+/** Options of the native contour generator.
+ * Passing ContourOptions to contour computes the iso-lines (or the filled bands)
+ * in C++ and hands them to matplotlib as a ContourSet, so colorbar and clabel work as usual.
+ */
+struct ContourOptions
+{
+    explicit ContourOptions(bool filled = false, unsigned nthreads = 0) : filled(filled), nthreads(nthreads) {}
+
+    bool filled;        // filled bands between consecutive levels instead of lines
+    unsigned nthreads;  // 0: std::thread::hardware_concurrency()
+};
+
+namespace detail
+{
+/** Compound path of one level (lines) or one band (filled), in matplotlib Path codes. */
+struct ContourPath
+{
+    static const std::uint8_t MOVETO    = 1;
+    static const std::uint8_t LINETO    = 2;
+    static const std::uint8_t CLOSEPOLY = 79;
+
+    void append(const ContourPath& other)
+    {
+        this->vertices.insert(this->vertices.end(), other.vertices.begin(), other.vertices.end());
+        this->codes.insert(this->codes.end(), other.codes.begin(), other.codes.end());
+    }
+
+    void point(double x, double y, std::uint8_t code)
+    {
+        this->vertices.push_back(x);
+        this->vertices.push_back(y);
+        this->codes.push_back(code);
+    }
+
+    std::vector<double> vertices;  // x0, y0, x1, y1, ...
+    std::vector<std::uint8_t> codes;
+};
+
+/** Levels of a contour over [zmin, zmax] with about nlevels levels, picked by MaxNLocator like matplotlib.
+ * Lines only keep the levels inside the range.
+ */
+inline std::vector<double> get_contour_levels(double zmin, double zmax, long nlevels, bool filled)
+{
+    NewRef ticker = PyImport_ImportModule("matplotlib.ticker");
+    if (!ticker) {
+        throw std::runtime_error("Error loading module matplotlib.ticker!");
+    }
+    NewRef locator = PyObject_CallMethod(ticker, "MaxNLocator", "l", nlevels + 1);
+    NewRef values  = locator ? PyObject_CallMethod(locator, "tick_values", "dd", zmin, zmax) : nullptr;
+    NewRef list    = values ? PySequence_List(values) : nullptr;
+    if (!list) {
+        throw std::runtime_error("Couldn't compute the contour levels.");
+    }
+    std::vector<double> levels;
+    for (Py_ssize_t i = 0; i < PyList_Size(list); ++i) {
+        double level = PyFloat_AsDouble(PyList_GetItem(list, i));
+        if (filled || (level >= zmin && level <= zmax)) {
+            levels.push_back(level);
+        }
+    }
+    if (levels.empty()) {
+        levels.push_back(zmin);
+    }
+    return levels;
+}
+
+/** Marching triangles on a rectilinear grid, z is row-major with y.size() rows and x.size() columns.
+ * Every cell is split along its diagonal, which leaves no ambiguous saddle cases.
+ * Cells with a non-finite corner are skipped. The grid is processed in row tiles,
+ * one thread per tile, iso-line segments are then stitched per level on edge ids.
+ */
+template <typename ScalarX, typename ScalarY, typename ScalarZ>
+class ContourGenerator
+{
+public:
+    ContourGenerator(const ScalarX* x, const ScalarY* y, const ScalarZ* z, long rows, long cols, unsigned nthreads = 0)
+        : x(x),
+          y(y),
+          z(z),
+          rows(rows),
+          cols(cols),
+          nthreads(nthreads ? nthreads : std::max(std::thread::hardware_concurrency(), 1u))
+    {
+    }
+
+    /**
+     * @brief Iso-lines of the levels, levels must be increasing.
+     */
+    std::vector<ContourPath> lines(const std::vector<double>& levels) const
+    {
+        typedef std::vector<std::pair<std::int64_t, std::int64_t>> Segments;  // edge ids of both ends
+
+        std::vector<std::vector<Segments>> tiles(this->ntiles(), std::vector<Segments>(levels.size()));
+        detail::parallel_for(tiles.size(), this->nthreads, [&](std::size_t t) {
+            auto& segments = tiles[t];
+            long end       = this->tile_begin(t + 1, tiles.size());
+            for (long i = this->tile_begin(t, tiles.size()); i < end; ++i) {
+                for (long j = 0; j + 1 < this->cols; ++j) {
+                    if (!this->finite_cell(i, j)) {
+                        continue;
+                    }
+                    // lower triangle (i, j), (i, j + 1), (i + 1, j + 1) and upper triangle (i, j), (i + 1, j + 1), (i + 1, j)
+                    this->triangle_segments(levels, {{this->node(i, j), this->node(i, j + 1), this->node(i + 1, j + 1)}},
+                                            {{this->edge(i, j, 0), this->edge(i, j + 1, 1), this->edge(i, j, 2)}},
+                                            segments);
+                    this->triangle_segments(levels, {{this->node(i, j), this->node(i + 1, j + 1), this->node(i + 1, j)}},
+                                            {{this->edge(i, j, 2), this->edge(i + 1, j, 0), this->edge(i, j, 1)}},
+                                            segments);
+                }
+            }
+        });
+
+        std::vector<ContourPath> paths(levels.size());
+        detail::parallel_for(levels.size(), this->nthreads, [&](std::size_t k) {
+            Segments segments;
+            for (auto& tile : tiles) {
+                segments.insert(segments.end(), tile[k].begin(), tile[k].end());
+                Segments().swap(tile[k]);
+            }
+            this->stitch(segments, levels[k], paths[k]);
+        });
+        return paths;
+    }
+
+    /**
+     * @brief Filled bands between consecutive levels, band k is levels[k] < z <= levels[k + 1].
+     *
+     * Runs of cells lying completely in one band are merged into a single rectangle.
+     */
+    std::vector<ContourPath> bands(const std::vector<double>& levels) const
+    {
+        std::size_t nbands = levels.size() < 2 ? 0 : levels.size() - 1;
+        std::vector<std::vector<ContourPath>> tiles(this->ntiles(), std::vector<ContourPath>(nbands));
+        detail::parallel_for(tiles.size(), this->nthreads, [&](std::size_t t) {
+            auto& paths = tiles[t];
+            long end    = this->tile_begin(t + 1, tiles.size());
+            for (long i = this->tile_begin(t, tiles.size()); i < end; ++i) {
+                long run_start = -1, run_band = -1;
+                auto flush     = [&](long j) {
+                    if (run_start >= 0) {
+                        this->rectangle(i, run_start, j, paths[run_band]);
+                    }
+                    run_start = -1;
+                };
+                for (long j = 0; j + 1 < this->cols; ++j) {
+                    if (!this->finite_cell(i, j)) {
+                        flush(j);
+                        continue;
+                    }
+                    double zc[4] = {double(this->z[i * this->cols + j]), double(this->z[i * this->cols + j + 1]),
+                                    double(this->z[(i + 1) * this->cols + j + 1]),
+                                    double(this->z[(i + 1) * this->cols + j])};
+                    long first = this->band(levels, *std::min_element(zc, zc + 4));
+                    long last  = this->band(levels, *std::max_element(zc, zc + 4));
+                    if (first == last && first >= 0 && first < long(nbands)) {
+                        if (run_start < 0 || run_band != first) {
+                            flush(j);
+                            run_start = j;
+                            run_band  = first;
+                        }
+                        continue;
+                    }
+                    flush(j);
+                    for (long k = std::max(first, 0L); k <= std::min(last, long(nbands) - 1); ++k) {
+                        this->clip_triangle(levels, k, {{this->node(i, j), this->node(i, j + 1), this->node(i + 1, j + 1)}},
+                                            paths[k]);
+                        this->clip_triangle(levels, k, {{this->node(i, j), this->node(i + 1, j + 1), this->node(i + 1, j)}},
+                                            paths[k]);
+                    }
+                }
+                flush(this->cols - 1);
+            }
+        });
+
+        std::vector<ContourPath> paths(nbands);
+        detail::parallel_for(nbands, this->nthreads, [&](std::size_t k) {
+            for (auto& tile : tiles) {
+                paths[k].append(tile[k]);
+                tile[k] = ContourPath();
+            }
+        });
+        return paths;
+    }
+
+private:
+    struct Node
+    {
+        double x, y, z;
+    };
+
+    Node node(long i, long j) const
+    {
+        return {double(this->x[j]), double(this->y[i]), double(this->z[i * this->cols + j])};
+    }
+
+    // Edge ids: 0 from (i, j) to (i, j + 1), 1 from (i, j) to (i + 1, j), 2 the diagonal to (i + 1, j + 1).
+    std::int64_t edge(long i, long j, int type) const
+    {
+        return 3 * (std::int64_t(i) * this->cols + j) + type;
+    }
+
+    // Crossing of the level on an edge, computed from the edge id alone so both triangles agree.
+    std::pair<double, double> crossing(std::int64_t id, double level) const
+    {
+        long cell = long(id / 3), i = cell / this->cols, j = cell % this->cols;
+        int type = int(id % 3);
+        Node a   = this->node(i, j);
+        Node b   = type == 0 ? this->node(i, j + 1) : type == 1 ? this->node(i + 1, j) : this->node(i + 1, j + 1);
+        double t = (level - a.z) / (b.z - a.z);
+        return {a.x + t * (b.x - a.x), a.y + t * (b.y - a.y)};
+    }
+
+    bool finite_cell(long i, long j) const
+    {
+        const ScalarZ* row = this->z + i * this->cols + j;
+        return std::isfinite(double(row[0])) && std::isfinite(double(row[1])) &&
+               std::isfinite(double(row[this->cols])) && std::isfinite(double(row[this->cols + 1]));
+    }
+
+    // A node is above the level when z >= level, a triangle edge is crossed when its nodes differ.
+    template <typename Segments>
+    void triangle_segments(const std::vector<double>& levels,
+                           const std::array<Node, 3>& nodes,
+                           const std::array<std::int64_t, 3>& edges,
+                           std::vector<Segments>& segments) const
+    {
+        double zmin = std::min({nodes[0].z, nodes[1].z, nodes[2].z});
+        double zmax = std::max({nodes[0].z, nodes[1].z, nodes[2].z});
+        // levels with zmin < level <= zmax
+        auto k   = std::upper_bound(levels.begin(), levels.end(), zmin) - levels.begin();
+        auto end = std::upper_bound(levels.begin(), levels.end(), zmax) - levels.begin();
+        for (; k < end; ++k) {
+            bool above[3] = {nodes[0].z >= levels[k], nodes[1].z >= levels[k], nodes[2].z >= levels[k]};
+            // edge e goes from node e to node (e + 1) % 3
+            std::int64_t ends[2];
+            int n = 0;
+            for (int e = 0; e < 3; ++e) {
+                if (above[e] != above[(e + 1) % 3]) {
+                    ends[n++] = edges[e];
+                }
+            }
+            segments[k].emplace_back(ends[0], ends[1]);
+        }
+    }
+
+    // Joins the segments sharing an edge into polylines, closed loops end with CLOSEPOLY.
+    template <typename Segments>
+    void stitch(const Segments& segments, double level, ContourPath& path) const
+    {
+        // entry 2 * s + e is end e of segment s, every edge is shared by at most two entries
+        std::vector<std::pair<std::int64_t, std::int64_t>> entries(2 * segments.size());
+        for (std::size_t s = 0; s < segments.size(); ++s) {
+            entries[2 * s]     = {segments[s].first, std::int64_t(2 * s)};
+            entries[2 * s + 1] = {segments[s].second, std::int64_t(2 * s + 1)};
+        }
+        std::sort(entries.begin(), entries.end());
+        std::vector<std::int64_t> link(entries.size(), -1);
+        for (std::size_t k = 0; k + 1 < entries.size(); ++k) {
+            if (entries[k].first == entries[k + 1].first) {
+                link[entries[k].second]     = entries[k + 1].second;
+                link[entries[k + 1].second] = entries[k].second;
+            }
+        }
+
+        std::vector<bool> visited(segments.size(), false);
+        auto end_edge = [&](std::int64_t entry) {
+            return entry % 2 ? segments[entry / 2].second : segments[entry / 2].first;
+        };
+        auto walk = [&](std::int64_t entry) {
+            auto p = this->crossing(end_edge(entry), level);
+            path.point(p.first, p.second, ContourPath::MOVETO);
+            while (true) {
+                visited[entry / 2] = true;
+                std::int64_t out   = entry ^ 1;
+                std::int64_t next  = link[out];
+                bool closed        = next >= 0 && visited[next / 2];
+                p                  = this->crossing(end_edge(out), level);
+                path.point(p.first, p.second, closed ? ContourPath::CLOSEPOLY : ContourPath::LINETO);
+                if (next < 0 || closed) {
+                    return;
+                }
+                entry = next;
+            }
+        };
+        // open lines start at an unlinked end, what is left are closed loops
+        for (std::size_t e = 0; e < link.size(); ++e) {
+            if (link[e] < 0 && !visited[e / 2]) {
+                walk(std::int64_t(e));
+            }
+        }
+        for (std::size_t s = 0; s < segments.size(); ++s) {
+            if (!visited[s]) {
+                walk(std::int64_t(2 * s));
+            }
+        }
+    }
+
+    // Band of a value, -1 below the first level and nbands above the last one.
+    static long band(const std::vector<double>& levels, double value)
+    {
+        if (value == levels.front()) {
+            return 0;  // the lowest band is closed at both ends
+        }
+        return long(std::lower_bound(levels.begin(), levels.end(), value) - levels.begin()) - 1;
+    }
+
+    // Clips the triangle to levels[k] <= z <= levels[k + 1], z is linear on the triangle.
+    void clip_triangle(const std::vector<double>& levels, long k, const std::array<Node, 3>& nodes, ContourPath& path) const
+    {
+        Node lower[4], polygon[5];
+        int n = clip(nodes.data(), 3, levels[k], 1.0, lower);
+        n     = clip(lower, n, levels[k + 1], -1.0, polygon);
+        if (n < 3) {
+            return;
+        }
+        for (int a = 0; a < n; ++a) {
+            path.point(polygon[a].x, polygon[a].y, a == 0 ? ContourPath::MOVETO : ContourPath::LINETO);
+        }
+        path.point(polygon[0].x, polygon[0].y, ContourPath::CLOSEPOLY);
+    }
+
+    // Sutherland-Hodgman step keeping sign * (z - level) >= 0, returns the size of out.
+    static int clip(const Node* in, int n, double level, double sign, Node* out)
+    {
+        int m = 0;
+        for (int a = 0; a < n; ++a) {
+            const Node& p = in[a];
+            const Node& q = in[(a + 1) % n];
+            double fp = sign * (p.z - level), fq = sign * (q.z - level);
+            if (fp >= 0) {
+                out[m++] = p;
+            }
+            if ((fp >= 0) != (fq >= 0)) {
+                double t = fp / (fp - fq);
+                out[m++] = {p.x + t * (q.x - p.x), p.y + t * (q.y - p.y), level};
+            }
+        }
+        return m;
+    }
+
+    // Cells j0 to j1 - 1 of row i.
+    void rectangle(long i, long j0, long j1, ContourPath& path) const
+    {
+        double x0 = double(this->x[j0]), x1 = double(this->x[j1]);
+        double y0 = double(this->y[i]), y1 = double(this->y[i + 1]);
+        path.point(x0, y0, ContourPath::MOVETO);
+        path.point(x1, y0, ContourPath::LINETO);
+        path.point(x1, y1, ContourPath::LINETO);
+        path.point(x0, y1, ContourPath::LINETO);
+        path.point(x0, y0, ContourPath::CLOSEPOLY);
+    }
+
+    std::size_t ntiles() const
+    {
+        return std::size_t(std::max(1L, std::min(long(this->nthreads), (this->rows - 1) / 16)));
+    }
+
+    // First cell row of tile t, tile ntiles begins past the last row.
+    long tile_begin(std::size_t t, std::size_t ntiles) const
+    {
+        return long(std::int64_t(this->rows - 1) * std::int64_t(t) / std::int64_t(ntiles));
+    }
+
+    const ScalarX* x;
+    const ScalarY* y;
+    const ScalarZ* z;
+    long rows;
+    long cols;
+    unsigned nthreads;
+};
+}  // namespace detail
+}  // namespace matplotlibcpp
+
+#endif  // !__PLT_CONTOUR_HPP__
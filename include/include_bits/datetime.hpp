@@ -0,0 +1,139 @@
+#ifndef __PLT_DATETIME_HPP__
+#define __PLT_DATETIME_HPP__
+
+#include <chrono>
+#include <memory>
+#include <ratio>
+#include <type_traits>
+#include "utility.hpp"
+
+namespace matplotlibcpp
+{
+namespace detail
+{
+/** numpy datetime64 unit of a std::chrono period, nullptr if there is none. */
+template <typename Period>
+struct datetime_unit
+{
+    static const char* get()
+    {
+        return nullptr;
+    }
+};
+
+#define MATPLOTLIBCPP_DATETIME_UNIT(P, U) \
+    template <>                           \
+    struct datetime_unit<P>               \
+    {                                     \
+        static const char* get()          \
+        {                                 \
+            return U;                     \
+        }                                 \
+    }
+
+MATPLOTLIBCPP_DATETIME_UNIT(std::nano, "ns");
+MATPLOTLIBCPP_DATETIME_UNIT(std::micro, "us");
+MATPLOTLIBCPP_DATETIME_UNIT(std::milli, "ms");
+MATPLOTLIBCPP_DATETIME_UNIT(std::ratio<1>, "s");
+MATPLOTLIBCPP_DATETIME_UNIT(std::ratio<60>, "m");
+MATPLOTLIBCPP_DATETIME_UNIT(std::ratio<3600>, "h");
+MATPLOTLIBCPP_DATETIME_UNIT(std::ratio<86400>, "D");
+
+#undef MATPLOTLIBCPP_DATETIME_UNIT
+}  // namespace detail
+
+/** Timestamps since the Unix epoch in a numpy datetime64 unit ("ns", "us", "ms", "s", "m", "h" or "D").
+ * They are handed to matplotlib as one datetime64 view of the buffer, which must outlive the call,
+ * and the axis gets a date locator with a ConciseDateFormatter.
+ * time_points must be of system_clock, those whose representation is a 64-bit count of one of
+ * these units are viewed without copying, others are converted to nanoseconds.
+ */
+struct TimeStamps
+{
+    TimeStamps(const std::int64_t* data, std::size_t size, const std::string& unit = "ns")
+        : data(data), size(size), unit(unit)
+    {
+    }
+
+    explicit TimeStamps(const std::vector<std::int64_t>& stamps, const std::string& unit = "ns")
+        : data(stamps.data()), size(stamps.size()), unit(unit)
+    {
+    }
+
+    template <typename Clock, typename Duration>
+    explicit TimeStamps(const std::vector<std::chrono::time_point<Clock, Duration>>& points) : size(points.size())
+    {
+        // other clocks, e.g. steady_clock, don't count from the Unix epoch
+        static_assert(std::is_same<Clock, std::chrono::system_clock>::value,
+                      "TimeStamps: time_points must be of std::chrono::system_clock");
+        typedef std::chrono::time_point<Clock, Duration> TimePoint;
+        const char* view_unit = detail::datetime_unit<typename Duration::period>::get();
+        if (view_unit && std::is_integral<typename Duration::rep>::value &&
+            sizeof(typename Duration::rep) == sizeof(std::int64_t) && sizeof(TimePoint) == sizeof(std::int64_t)) {
+            this->data = reinterpret_cast<const std::int64_t*>(points.data());
+            this->unit = view_unit;
+            return;
+        }
+        this->converted = std::make_shared<std::vector<std::int64_t>>(points.size());
+        for (std::size_t k = 0; k < points.size(); ++k) {
+            (*this->converted)[k] =
+                std::chrono::duration_cast<std::chrono::nanoseconds>(points[k].time_since_epoch()).count();
+        }
+        this->data = this->converted->data();
+        this->unit = "ns";
+    }
+
+    const std::int64_t* data;
+    std::size_t size;
+    std::string unit;
+    std::shared_ptr<std::vector<std::int64_t>> converted;  // owns data if the time_points were converted
+};
+
+namespace detail
+{
+/**
+ * @brief datetime64 ndarray viewing the timestamps, without copying them.
+ */
+inline NewRef get_datetime64(const TimeStamps& stamps)
+{
+    NewRef view = get_pyarray_view(stamps.data, {npy_intp(stamps.size)});
+    std::string dtype = "datetime64[" + stamps.unit + "]";
+    PyObject* dates = PyObject_CallMethod(view, "view", "s", dtype.c_str());
+    if (!dates) {
+        throw std::runtime_error("Unknown datetime64 unit: " + stamps.unit);
+    }
+    return dates;
+}
+
+/**
+ * @brief Replaces the default date formatter of an axis by a ConciseDateFormatter on its locator.
+ *
+ * A formatter set by the user is kept.
+ */
+inline void set_date_formatter(PyObject* ax, const char* axis_name = "xaxis")
+{
+    NewRef dates = PyImport_ImportModule("matplotlib.dates");
+    if (!dates) {
+        throw std::runtime_error("Error loading module matplotlib.dates!");
+    }
+    NewRef axis          = PyObject_GetAttrString(ax, axis_name);
+    NewRef auto_class    = PyObject_GetAttrString(dates, "AutoDateFormatter");
+    Load_func formatter("get_major_formatter", axis);
+    formatter.call();
+    if (!PyObject_IsInstance(formatter.res, auto_class)) {
+        return;
+    }
+    Load_func locator("get_major_locator", axis);
+    locator.call();
+    PyContainer locator_args;
+    locator_args << BorrowedRef(locator.res);
+    Load_func concise("ConciseDateFormatter", dates);
+    concise.call(locator_args.to_tuple());
+    PyContainer args;
+    args << BorrowedRef(concise.res);
+    Load_func("set_major_formatter", axis).call(args.to_tuple());
+}
+}  // namespace detail
+}  // namespace matplotlibcpp
+
+#endif  // !__PLT_DATETIME_HPP__
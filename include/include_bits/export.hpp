@@ -0,0 +1,215 @@
+#ifndef __PLT_EXPORT_HPP__
+#define __PLT_EXPORT_HPP__
+
+#include <fstream>
+#include <map>
+#include "render_cache.hpp"
+
+namespace matplotlibcpp
+{
+/** Output of savefig_multi: a file, or a buffer that receives the encoded bytes.
+ * The format is taken from the file extension when it is empty.
+ */
+struct SaveTarget
+{
+    SaveTarget(const std::string& filename, long dpi = 100, const std::string& format = "")
+        : filename(filename), buffer(nullptr), format(format), dpi(dpi)
+    {
+    }
+
+    SaveTarget(std::vector<char>& buffer, const std::string& format, long dpi = 100)
+        : buffer(&buffer), format(format), dpi(dpi)
+    {
+    }
+
+    std::string filename;
+    std::vector<char>* buffer;
+    std::string format;
+    long dpi;
+};
+
+namespace detail
+{
+// Formats written from the Agg buffer.
+inline bool is_raster_format(const std::string& format)
+{
+    for (const char* raster : {"png", "jpg", "jpeg", "tif", "tiff", "webp", "raw", "rgba"}) {
+        if (format == raster) {
+            return true;
+        }
+    }
+    return false;
+}
+
+inline void write_bytes(const SaveTarget& target, const char* data, std::size_t size)
+{
+    if (target.buffer) {
+        target.buffer->assign(data, data + size);
+        return;
+    }
+    std::ofstream out(target.filename, std::ios::binary);
+    out.write(data, std::streamsize(size));
+    if (!out) {
+        throw std::runtime_error("Couldn't write " + target.filename);
+    }
+}
+
+/**
+ * @brief Saves fig to all targets with one layout and one Agg draw per raster dpi.
+ *
+ * The layout engine runs once and is disabled for the draws. Raster targets of a dpi share
+ * one Agg render whose buffer is encoded on worker threads, which run while the next dpi and
+ * the vector formats are drawn. The figure's dpi, canvas and layout engine are restored.
+ */
+inline void savefig_multi(PyObject* fig, const std::vector<SaveTarget>& targets, unsigned nthreads)
+{
+    NewRef io          = PyImport_ImportModule("io");
+    NewRef futures     = PyImport_ImportModule("concurrent.futures");
+    NewRef image       = PyImport_ImportModule("matplotlib.image");
+    NewRef backend_agg = PyImport_ImportModule("matplotlib.backends.backend_agg");
+    NewRef numpy       = PyImport_ImportModule("numpy");
+    if (!io || !futures || !image || !backend_agg || !numpy) {
+        throw std::runtime_error("Error loading the modules of savefig_multi!");
+    }
+    NewRef rcparams       = PyObject_GetAttrString(image, "mpl");
+    NewRef rc             = PyObject_GetAttrString(rcparams, "rcParams");
+    NewRef default_format = PyMapping_GetItemString(rc, "savefig.format");
+
+    std::vector<std::string> formats;
+    std::map<long, std::vector<std::size_t>> raster;
+    std::vector<std::size_t> vector;
+    for (std::size_t k = 0; k < targets.size(); ++k) {
+        std::string format = get_format(targets[k].filename, targets[k].format);
+        format             = format.empty() ? PyUnicode_AsUTF8(default_format) : format;
+        std::transform(format.begin(), format.end(), format.begin(), ::tolower);
+        formats.push_back(format);
+        if (is_raster_format(format)) {
+            raster[targets[k].dpi].push_back(k);
+        } else {
+            vector.push_back(k);
+        }
+    }
+
+    // python outputs, BytesIO for buffers
+    PyContainer outputs;
+    for (const auto& target : targets) {
+        if (target.buffer) {
+            Load_func bytes_io("BytesIO", io);
+            bytes_io.call();
+            outputs << BorrowedRef(bytes_io.res);
+        } else {
+            outputs << target.filename;
+        }
+    }
+    NewRef output_list = outputs.to_list();
+
+    Load_func get_engine("get_layout_engine", fig);
+    get_engine.call();
+    BorrowedRef engine(get_engine.res);
+    NewRef dpi    = PyObject_GetAttrString(fig, "dpi");
+    NewRef canvas = PyObject_GetAttrString(fig, "canvas");
+    if (engine != Py_None) {
+        PyContainer args;
+        args << BorrowedRef(fig);
+        Load_func("execute", engine).call(args.to_tuple());
+        PyContainer none;
+        none << std::string("none");
+        Load_func("set_layout_engine", fig).call(none.to_tuple());
+    }
+
+    auto restore = [&]() {
+        PyObject_SetAttrString(fig, "dpi", dpi);
+        PyContainer args;
+        args << canvas;
+        Load_func("set_canvas", fig).call(args.to_tuple());
+        if (engine != Py_None) {
+            PyContainer layout;
+            layout << engine;
+            Load_func("set_layout_engine", fig).call(layout.to_tuple());
+        }
+    };
+
+    try {
+        Load_func executor("ThreadPoolExecutor", futures);
+        NewRef executor_kwargs = PyDict_New();
+        if (nthreads > 0) {
+            set_item(executor_kwargs, "max_workers", PyLong_FromLong(nthreads));
+        }
+        executor.call(nullptr, executor_kwargs);
+        Load_func submit("submit", executor.res);
+        NewRef imsave    = PyObject_GetAttrString(image, "imsave");
+        NewRef agg_class = PyObject_GetAttrString(backend_agg, "FigureCanvasAgg");
+        auto get_canvas  = [&]() -> NewRef {
+            if (PyObject_IsInstance(canvas, agg_class)) {
+                Py_INCREF(canvas);
+                return (PyObject*)canvas;
+            }
+            PyContainer args;
+            args << BorrowedRef(fig);
+            return PyObject_CallObject(agg_class, args.to_tuple());
+        };
+        std::vector<NewRef> pending;
+
+        for (const auto& group : raster) {
+            PyObject_SetAttrString(fig, "dpi", NewRef(PyFloat_FromDouble(double(group.first))));
+            // a new canvas starts with empty text caches, the figure's own is reused if it is an Agg one
+            NewRef agg = get_canvas();
+            Load_func("draw", agg).call();
+            Load_func buffer("buffer_rgba", agg);
+            buffer.call();
+            PyContainer asarray_args;
+            asarray_args << BorrowedRef(buffer.res);
+            Load_func rgba("asarray", numpy);
+            rgba.call(asarray_args.to_tuple());
+
+            for (std::size_t k : group.second) {
+                if (formats[k] == "raw" || formats[k] == "rgba") {
+                    auto array = (PyArrayObject*)rgba.res;
+                    write_bytes(targets[k], (const char*)PyArray_DATA(array), std::size_t(PyArray_NBYTES(array)));
+                    continue;
+                }
+                PyContainer args;
+                args << imsave << BorrowedRef(PyList_GetItem(output_list, k)) << BorrowedRef(rgba.res);
+                NewRef kwargs = PyDict_New();
+                set_item(kwargs, "format", PyUnicode_FromString(formats[k].c_str()));
+                set_item(kwargs, "dpi", PyLong_FromLong(group.first));
+                submit.call(args.to_tuple(), kwargs);
+                submit.incref_res();
+                pending.emplace_back(submit.res);
+            }
+        }
+        PyObject_SetAttrString(fig, "dpi", dpi);
+
+        // the vector formats are drawn while the raster targets are encoded
+        for (std::size_t k : vector) {
+            PyContainer args;
+            args << BorrowedRef(PyList_GetItem(output_list, k));
+            NewRef kwargs = PyDict_New();
+            set_item(kwargs, "format", PyUnicode_FromString(formats[k].c_str()));
+            set_item(kwargs, "dpi", PyLong_FromLong(targets[k].dpi));
+            Load_func("savefig", fig).call(args.to_tuple(), kwargs);
+        }
+
+        // result() raises the exception of a failed encoding
+        for (auto& future : pending) {
+            Load_func("result", future).call();
+        }
+        Load_func("shutdown", executor.res).call();
+    } catch (...) {
+        restore();
+        throw;
+    }
+    restore();
+
+    for (std::size_t k = 0; k < targets.size(); ++k) {
+        if (targets[k].buffer && formats[k] != "raw" && formats[k] != "rgba") {
+            Load_func value("getvalue", PyList_GetItem(output_list, k));
+            value.call();
+            write_bytes(targets[k], PyBytes_AsString(value.res), std::size_t(PyBytes_Size(value.res)));
+        }
+    }
+}
+}  // namespace detail
+}  // namespace matplotlibcpp
+
+#endif  // !__PLT_EXPORT_HPP__
@@ -7,12 +7,66 @@ namespace matplotlibcpp
 {
 namespace detail
 {
+/** Handle of a matplotlib Figure, owning a reference to it. */
 class Figure
 {
 public:
-    Figure(PyObject* fig) : fig(fig) {}
+    Figure(PyObject* fig) : fig(fig)
+    {
+        if (!fig) {
+            throw std::runtime_error("fig is nullptr");
+        }
+        Py_INCREF(this->fig);
+    }
+
+    Figure(const Figure& other) : fig(other.fig)
+    {
+        Py_INCREF(this->fig);
+    }
+
+    Figure& operator=(const Figure& other)
+    {
+        Py_INCREF(other.fig);
+        Py_DECREF(this->fig);
+        this->fig = other.fig;
+        return *this;
+    }
+
+    ~Figure()
+    {
+        Py_DECREF(this->fig);
+    }
+
+    void savefig(const std::string& filename, long dpi = 100, const std::string& format = "") const
+    {
+        detail::PyContainer args;
+        args << filename;
+        detail::NewRef kwargs = PyDict_New();
+        if (dpi > 0)
+            detail::set_item(kwargs, "dpi", PyLong_FromLong(dpi));
+        if (!format.empty())
+            detail::set_item(kwargs, "format", PyUnicode_FromString(format.c_str()));
+        auto func = this->get_func("savefig");
+        func.call(args.to_tuple(), kwargs);
+    }
+
+    long number() const
+    {
+        detail::NewRef num = PyObject_GetAttrString(this->fig, "number");
+        return PyLong_AsLong(num);
+    }
+
+    PyObject* get_fig() const
+    {
+        return this->fig;
+    }
 
 private:
+    Load_func get_func(const std::string& name) const
+    {
+        return Load_func(name, this->fig);
+    }
+
     PyObject* fig;
 };
 }  // namespace detail
@@ -0,0 +1,418 @@
+#ifndef __PLT_FIGURE_POOL_HPP__
+#define __PLT_FIGURE_POOL_HPP__
+
+#include <algorithm>
+#include <list>
+#include <tuple>
+#include "artist.hpp"
+#include "axes.hpp"
+#include "figure.hpp"
+#include "modules.hpp"
+
+namespace matplotlibcpp
+{
+/** Layout of a pooled figure, figures are only reused for an identical layout. */
+struct FigureLayout
+{
+    FigureLayout(double width              = 6.4,
+                 double height             = 4.8,
+                 long dpi                  = 100,
+                 long nrows                = 1,
+                 long ncols                = 1,
+                 const std::string& sharex = "none",
+                 const std::string& sharey = "none")
+        : width(width), height(height), dpi(dpi), nrows(nrows), ncols(ncols), sharex(sharex), sharey(sharey)
+    {
+    }
+
+    bool operator==(const FigureLayout& other) const
+    {
+        return std::tie(width, height, dpi, nrows, ncols, sharex, sharey) ==
+               std::tie(other.width, other.height, other.dpi, other.nrows, other.ncols, other.sharex, other.sharey);
+    }
+
+    // size of the Agg canvas of the figure
+    std::size_t bytes() const
+    {
+        return std::size_t(width * dpi) * std::size_t(height * dpi) * 4;
+    }
+
+    double width;   // inches
+    double height;  // inches
+    long dpi;
+    long nrows;
+    long ncols;
+    std::string sharex;
+    std::string sharey;
+};
+
+namespace detail
+{
+/** Pool of figures reused across renders.
+ * A released figure keeps its axes and spines, its artists, labels and titles are removed,
+ * axes added to it like colorbars are deleted, and scales, units, tick locators and formatters,
+ * grid, tick_params, tick and label positions, axis on/off, frame and facecolors are back to
+ * those of a new figure. Styling set on other objects, e.g. the spines or the tick label texts,
+ * is not undone: such figures should be closed rather than released. At most max_figures idle
+ * figures using at most max_bytes of canvas are kept, the least recently used ones are closed.
+ */
+class FigurePool
+{
+public:
+    FigurePool(Modules& modules, std::size_t max_figures = 8, std::size_t max_bytes = std::size_t(256) << 20)
+        : modules(modules), max_figures(max_figures), max_bytes(max_bytes)
+    {
+    }
+
+    void set_limits(std::size_t max_figures, std::size_t max_bytes)
+    {
+        this->max_figures = max_figures;
+        this->max_bytes   = max_bytes;
+        this->evict();
+    }
+
+    /**
+     * @brief A figure with the layout, reused from the pool if possible. It becomes the current figure.
+     */
+    std::pair<Figure, Axes> acquire(const FigureLayout& layout)
+    {
+        detail::PyContainer args;
+        args << layout.nrows << layout.ncols;
+        detail::NewRef args_tuple = args.to_tuple();
+        detail::NewRef kwargs     = PyDict_New();
+        detail::set_item(kwargs, "figsize", Py_BuildValue("(dd)", layout.width, layout.height));
+        detail::set_item(kwargs, "dpi", PyLong_FromLong(layout.dpi));
+        detail::set_item(kwargs, "sharex", PyUnicode_FromString(layout.sharex.c_str()));
+        detail::set_item(kwargs, "sharey", PyUnicode_FromString(layout.sharey.c_str()));
+        Load_func func("subplots", this->modules.plt);
+
+        for (auto it = this->idle.rbegin(); it != this->idle.rend(); ++it) {
+            if (it->layout == layout) {
+                Entry entry = *it;
+                this->idle.erase(std::next(it).base());
+                this->in_use.push_back(entry);
+                // a reused figure is reported like a new one, the hooks may have forgotten its layout
+                detail::notify_call(func.fn, args_tuple, kwargs);
+                detail::notify_return(func.fn);
+                this->make_current(entry.fig);
+                return {entry.fig, entry.axes};
+            }
+        }
+
+        func.call(args_tuple, kwargs);
+        Entry entry{layout, Figure(PyTuple_GetItem(func.res, 0)),
+                    Axes(PyTuple_GetItem(func.res, 1), layout.nrows, layout.ncols), {}};
+        detail::NewRef fig_axes = PyObject_GetAttrString(entry.fig.get_fig(), "axes");
+        for (Py_ssize_t i = 0; i < PyList_Size(fig_axes); ++i) {
+            PyObject* ax               = PyList_GetItem(fig_axes, i);
+            detail::NewRef subplotspec = PyObject_CallMethod(ax, "get_subplotspec", nullptr);
+            detail::NewRef anchor      = PyObject_CallMethod(ax, "get_anchor", nullptr);
+            if (!subplotspec || !anchor) {
+                throw std::runtime_error("Couldn't read the layout of the axes.");
+            }
+            entry.layout_axes.push_back({Artist(ax), Artist(subplotspec), Artist(anchor)});
+            save_style(entry, ax);
+        }
+        save_setting(entry, entry.fig.get_fig(), "get_facecolor", "set_facecolor");
+        this->in_use.push_back(entry);
+        return {entry.fig, entry.axes};
+    }
+
+    /**
+     * @brief Clears a figure obtained from acquire and puts it back into the pool.
+     *
+     * Returns false if the figure does not come from the pool.
+     */
+    bool release(const Figure& fig)
+    {
+        for (auto it = this->in_use.begin(); it != this->in_use.end(); ++it) {
+            if (it->fig.get_fig() == fig.get_fig()) {
+                this->reset(*it);
+                this->idle.push_back(*it);
+                this->in_use.erase(it);
+                this->evict();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // number of figures waiting in the pool
+    std::size_t idle_size() const
+    {
+        return this->idle.size();
+    }
+
+    /**
+     * @brief Closes all idle figures and forgets the ones in use.
+     */
+    void clear()
+    {
+        std::size_t max_figures = this->max_figures;
+        this->max_figures       = 0;
+        this->evict();
+        this->max_figures = max_figures;
+        this->in_use.clear();
+    }
+
+private:
+    // an axes of the layout with its place in the figure, which a colorbar may take from it
+    struct LayoutAxes
+    {
+        Artist ax;
+        Artist subplotspec;
+        Artist anchor;
+    };
+
+    // a setting of the new figure, restored by obj.setter(value), or obj.setter() without a value
+    struct Setting
+    {
+        Artist obj;
+        std::string setter;
+        Artist value;
+    };
+
+    // the tick keywords of a new axis, they hold the grid, tick_params and the tick positions
+    struct TickKeywords
+    {
+        Artist axis;
+        Artist major;
+        Artist minor;
+        Artist tick_position;  // XAxis._tick_position, unset for a YAxis
+    };
+
+    struct Entry
+    {
+        FigureLayout layout;
+        Figure fig;
+        Axes axes;
+        std::vector<LayoutAxes> layout_axes;
+        std::vector<Setting> settings;
+        std::vector<TickKeywords> tick_keywords;
+    };
+
+    void make_current(const Figure& fig)
+    {
+        detail::PyContainer args;
+        args << fig.number();
+        Load_func func("figure", this->modules.plt);
+        func.call(args.to_tuple());
+    }
+
+    void evict()
+    {
+        std::size_t bytes = 0;
+        for (const auto& entry : this->idle) {
+            bytes += entry.layout.bytes();
+        }
+        while (!this->idle.empty() && (this->idle.size() > this->max_figures || bytes > this->max_bytes)) {
+            bytes -= this->idle.front().layout.bytes();
+            detail::PyContainer args;
+            args << detail::BorrowedRef(this->idle.front().fig.get_fig());
+            Load_func func("close", this->modules.plt);
+            func.call(args.to_tuple());
+            this->idle.pop_front();
+        }
+    }
+
+    static void call_method(PyObject* obj, const char* name, PyObject* args = nullptr, PyObject* kwargs = nullptr)
+    {
+        detail::NewRef method = PyObject_GetAttrString(obj, name);
+        detail::NewRef empty  = PyTuple_New(0);
+        detail::NewRef res    = method ? PyObject_Call(method, args ? args : (PyObject*)empty, kwargs) : nullptr;
+        if (!res) {
+            throw std::runtime_error(std::string("Call to ") + name + "() failed.");
+        }
+    }
+
+    static void save_setting(Entry& entry, PyObject* obj, const char* getter, const char* setter)
+    {
+        detail::NewRef value = PyObject_CallMethod(obj, getter, nullptr);
+        if (!value) {
+            throw std::runtime_error(std::string("Call to ") + getter + "() failed.");
+        }
+        entry.settings.push_back({Artist(obj), setter, Artist(value)});
+    }
+
+    // Records the styling of a new axes that reset() restores: facecolor, frame, axis on/off,
+    // grid, tick_params, tick and label positions.
+    static void save_style(Entry& entry, PyObject* ax)
+    {
+        save_setting(entry, ax, "get_facecolor", "set_facecolor");
+        save_setting(entry, ax, "get_frame_on", "set_frame_on");
+        detail::NewRef axison = PyObject_GetAttrString(ax, "axison");
+        entry.settings.push_back(
+            {Artist(ax), axison && PyObject_IsTrue(axison) == 0 ? "set_axis_off" : "set_axis_on", Artist()});
+        PyErr_Clear();
+        for (const char* axis_name : {"xaxis", "yaxis"}) {
+            detail::NewRef axis        = PyObject_GetAttrString(ax, axis_name);
+            detail::NewRef offset_text = axis ? PyObject_GetAttrString(axis, "offsetText") : nullptr;
+            detail::NewRef major       = axis ? PyObject_GetAttrString(axis, "_major_tick_kw") : nullptr;
+            detail::NewRef minor       = axis ? PyObject_GetAttrString(axis, "_minor_tick_kw") : nullptr;
+            if (!offset_text || !major || !minor) {
+                throw std::runtime_error("Couldn't read the ticks of the axes.");
+            }
+            TickKeywords keywords{Artist(axis), Artist(detail::NewRef(PyDict_Copy(major))),
+                                  Artist(detail::NewRef(PyDict_Copy(minor))), Artist()};
+            detail::NewRef tick_position = PyObject_GetAttrString(axis, "_tick_position");
+            if (tick_position) {
+                keywords.tick_position = Artist(tick_position);
+            }
+            PyErr_Clear();
+            entry.tick_keywords.push_back(keywords);
+            save_setting(entry, axis, "get_label_position", "set_label_position");
+            save_setting(entry, offset_text, "get_position", "set_position");
+            save_setting(entry, offset_text, "get_horizontalalignment", "set_horizontalalignment");
+            save_setting(entry, offset_text, "get_verticalalignment", "set_verticalalignment");
+            save_setting(entry, offset_text, "get_visible", "set_visible");
+        }
+    }
+
+    // Back to the saved tick keywords, the ticks are rebuilt from them when next drawn.
+    static void restore_style(const Entry& entry)
+    {
+        for (const auto& keywords : entry.tick_keywords) {
+            PyObject* axis = keywords.axis.get_artist();
+            std::pair<const char*, const Artist*> saved[] = {{"_major_tick_kw", &keywords.major},
+                                                             {"_minor_tick_kw", &keywords.minor}};
+            for (const auto& item : saved) {
+                detail::NewRef kw = PyObject_GetAttrString(axis, item.first);
+                if (!kw || !PyDict_Check(kw)) {
+                    throw std::runtime_error(std::string("Couldn't get ") + item.first + ".");
+                }
+                PyDict_Clear(kw);
+                PyDict_Update(kw, item.second->get_artist());
+            }
+            if (keywords.tick_position.get_artist()) {
+                PyObject_SetAttrString(axis, "_tick_position", keywords.tick_position.get_artist());
+            }
+            call_method(axis, "reset_ticks");
+        }
+        for (const auto& setting : entry.settings) {
+            if (setting.value.get_artist()) {
+                detail::NewRef args = Py_BuildValue("(O)", setting.value.get_artist());
+                call_method(setting.obj.get_artist(), setting.setter.c_str(), args);
+            } else {
+                call_method(setting.obj.get_artist(), setting.setter.c_str());
+            }
+        }
+    }
+
+    // Removes the artists of the sequence attribute name of obj.
+    static void remove_artists(PyObject* obj, const char* name)
+    {
+        detail::NewRef artists = PyObject_GetAttrString(obj, name);
+        detail::NewRef list    = artists ? PySequence_List(artists) : nullptr;
+        if (!list) {
+            throw std::runtime_error(std::string("Couldn't get ") + name + ".");
+        }
+        for (Py_ssize_t i = 0; i < PyList_Size(list); ++i) {
+            call_method(PyList_GetItem(list, i), "remove");
+        }
+    }
+
+    // Back to the state of a new figure, without rebuilding the axes of the layout and their spines.
+    static void reset(const Entry& entry)
+    {
+        PyObject* fig = entry.fig.get_fig();
+        auto find     = [&entry](PyObject* ax) {
+            return std::find_if(entry.layout_axes.begin(), entry.layout_axes.end(),
+                                [ax](const LayoutAxes& a) { return a.ax.get_artist() == ax; });
+        };
+        // colorbars first, while their mappables are still in the axes
+        detail::NewRef all_axes = PyObject_GetAttrString(fig, "axes");
+        detail::NewRef extra    = all_axes ? PySequence_List(all_axes) : nullptr;
+        if (!extra) {
+            throw std::runtime_error("Couldn't get axes.");
+        }
+        for (Py_ssize_t i = 0; i < PyList_Size(extra); ++i) {
+            PyObject* ax = PyList_GetItem(extra, i);
+            if (find(ax) == entry.layout_axes.end()) {
+                remove_axes(ax);
+            }
+        }
+
+        detail::NewRef axes = PyObject_GetAttrString(fig, "axes");
+        for (Py_ssize_t i = 0; i < PyList_Size(axes); ++i) {
+            PyObject* ax   = PyList_GetItem(axes, i);
+            auto layout_ax = find(ax);
+            for (const char* name : {"lines", "collections", "patches", "images", "texts", "tables", "artists"}) {
+                remove_artists(ax, name);
+            }
+            detail::NewRef legend = PyObject_GetAttrString(ax, "legend_");
+            if (legend && legend != Py_None) {
+                call_method(legend, "remove");
+            }
+            detail::NewRef containers = PyObject_GetAttrString(ax, "containers");
+            PyList_SetSlice(containers, 0, PyList_Size(containers), nullptr);
+
+            detail::PyContainer empty;
+            empty << std::string();
+            detail::NewRef empty_args = empty.to_tuple();
+            for (const char* loc : {"left", "center", "right"}) {
+                detail::NewRef kwargs = Py_BuildValue("{s:s}", "loc", loc);
+                call_method(ax, "set_title", empty_args, kwargs);
+            }
+            call_method(ax, "set_xlabel", empty_args);
+            call_method(ax, "set_ylabel", empty_args);
+
+            detail::NewRef none_args = Py_BuildValue("(O)", Py_None);
+            call_method(ax, "set_prop_cycle", none_args);
+            // linear scales with their default locators and formatters, without the units of dates
+            for (const char* axis_name : {"xaxis", "yaxis"}) {
+                detail::NewRef axis = PyObject_GetAttrString(ax, axis_name);
+                PyObject_SetAttrString(axis, "converter", Py_None);
+                PyObject_SetAttrString(axis, "units", Py_None);
+            }
+            detail::NewRef linear_args = Py_BuildValue("(s)", "linear");
+            call_method(ax, "set_xscale", linear_args);
+            call_method(ax, "set_yscale", linear_args);
+            detail::NewRef auto_args = Py_BuildValue("(s)", "auto");
+            call_method(ax, "set_aspect", auto_args);
+            // back to its cell of the layout, a colorbar may have shrunk it
+            detail::NewRef subplotspec_args = Py_BuildValue("(O)", layout_ax->subplotspec.get_artist());
+            if (layout_ax->subplotspec.get_artist() != Py_None) {
+                call_method(ax, "set_subplotspec", subplotspec_args);
+            }
+            detail::NewRef anchor_args = Py_BuildValue("(O)", layout_ax->anchor.get_artist());
+            call_method(ax, "set_anchor", anchor_args);
+            // unit view limits like a new axes, the next plot autoscales again
+            detail::NewRef unit = Py_BuildValue("(dd)", 0.0, 1.0);
+            call_method(ax, "set_xlim", unit);
+            call_method(ax, "set_ylim", unit);
+            call_method(ax, "relim");
+            detail::NewRef true_args = Py_BuildValue("(O)", Py_True);
+            call_method(ax, "set_autoscale_on", true_args);
+        }
+        // suptitle, supxlabel and supylabel are part of the figure texts
+        for (const char* name : {"texts", "legends", "images"}) {
+            remove_artists(fig, name);
+        }
+        for (const char* name : {"_suptitle", "_supxlabel", "_supylabel"}) {
+            if (PyObject_HasAttrString(fig, name)) {
+                PyObject_SetAttrString(fig, name, Py_None);
+            }
+        }
+        restore_style(entry);
+    }
+
+    // Deletes an axes that is not part of the layout, a colorbar also detaches from its mappable.
+    static void remove_axes(PyObject* ax)
+    {
+        detail::NewRef colorbar = PyObject_GetAttrString(ax, "_colorbar");
+        if (!colorbar) {
+            PyErr_Clear();
+        }
+        call_method(colorbar && colorbar != Py_None ? (PyObject*)colorbar : ax, "remove");
+    }
+
+    Modules& modules;
+    std::size_t max_figures;
+    std::size_t max_bytes;
+    std::list<Entry> idle;  // least recently used first
+    std::list<Entry> in_use;
+};
+}  // namespace detail
+}  // namespace matplotlibcpp
+
+#endif  // !__PLT_FIGURE_POOL_HPP__
@@ -0,0 +1,388 @@
+#ifndef __PLT_IPC_HPP__
+#define __PLT_IPC_HPP__
+
+// Wire protocol between the plot server and its clients, it does not depend on Python.
+// A frame is a uint32 length followed by the message, the file descriptors of the
+// arrays travel with the frame as SCM_RIGHTS ancillary data.
+
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace matplotlibcpp
+{
+namespace detail
+{
+enum WireType : std::uint8_t
+{
+    WIRE_NONE   = 0,
+    WIRE_BOOL   = 1,
+    WIRE_LONG   = 2,
+    WIRE_DOUBLE = 3,
+    WIRE_STRING = 4,
+    WIRE_ARRAY  = 5,  // dtype, shape and either the bytes or the index of a file descriptor
+    WIRE_HANDLE = 6,  // object kept by the server
+    WIRE_LIST   = 7,
+};
+
+// Arrays of at least this size are sent through a memfd instead of the socket.
+const std::size_t wire_fd_threshold = 64 * 1024;
+
+template <typename T>
+struct wire_dtype;
+
+#define MATPLOTLIBCPP_WIRE_DTYPE(T, C) \
+    template <>                        \
+    struct wire_dtype<T>               \
+    {                                  \
+        static const char value = C;   \
+    }
+
+// numpy typecodes
+MATPLOTLIBCPP_WIRE_DTYPE(double, 'd');
+MATPLOTLIBCPP_WIRE_DTYPE(float, 'f');
+MATPLOTLIBCPP_WIRE_DTYPE(std::int64_t, 'q');
+MATPLOTLIBCPP_WIRE_DTYPE(std::int32_t, 'i');
+MATPLOTLIBCPP_WIRE_DTYPE(std::uint8_t, 'B');
+
+#undef MATPLOTLIBCPP_WIRE_DTYPE
+
+/** Serialized message with the file descriptors it refers to. */
+class WireWriter
+{
+public:
+    WireWriter() = default;
+    WireWriter(const WireWriter&) = delete;
+    WireWriter& operator=(const WireWriter&) = delete;
+
+    WireWriter(WireWriter&& other) : bytes(std::move(other.bytes)), fds(std::move(other.fds))
+    {
+        other.fds.clear();
+    }
+
+    ~WireWriter()
+    {
+        for (int fd : this->fds) {
+            ::close(fd);
+        }
+    }
+
+    template <typename T>
+    void put(T value)
+    {
+        const char* p = reinterpret_cast<const char*>(&value);
+        this->bytes.insert(this->bytes.end(), p, p + sizeof(T));
+    }
+
+    void put_string(const std::string& s)
+    {
+        this->put(std::uint32_t(s.size()));
+        this->bytes.insert(this->bytes.end(), s.begin(), s.end());
+    }
+
+    void put_none()
+    {
+        this->put(WIRE_NONE);
+    }
+
+    void put_value(bool value)
+    {
+        this->put(WIRE_BOOL);
+        this->put(std::uint8_t(value));
+    }
+
+    void put_value(long value)
+    {
+        this->put(WIRE_LONG);
+        this->put(std::int64_t(value));
+    }
+
+    void put_value(int value)
+    {
+        this->put_value(long(value));
+    }
+
+    void put_value(double value)
+    {
+        this->put(WIRE_DOUBLE);
+        this->put(value);
+    }
+
+    void put_value(const std::string& value)
+    {
+        this->put(WIRE_STRING);
+        this->put_string(value);
+    }
+
+    void put_value(const char* value)
+    {
+        this->put_value(std::string(value));
+    }
+
+    void put_value(const std::vector<std::string>& values)
+    {
+        this->put(WIRE_LIST);
+        this->put(std::uint32_t(values.size()));
+        for (const auto& value : values) {
+            this->put_value(value);
+        }
+    }
+
+    void put_handle(std::uint64_t handle)
+    {
+        this->put(WIRE_HANDLE);
+        this->put(handle);
+    }
+
+    /**
+     * @brief An ndarray of the given shape, large arrays are copied into a memfd.
+     */
+    template <typename T>
+    void put_array(const T* data, const std::vector<std::int64_t>& shape)
+    {
+        std::size_t size = sizeof(T);
+        for (auto n : shape) {
+            size *= std::size_t(n);
+        }
+        this->put(WIRE_ARRAY);
+        this->put(wire_dtype<T>::value);
+        this->put(std::uint8_t(shape.size()));
+        for (auto n : shape) {
+            this->put(std::int64_t(n));
+        }
+        this->put(std::uint64_t(size));
+        if (size < wire_fd_threshold) {
+            this->put(std::uint8_t(0));
+            const char* p = reinterpret_cast<const char*>(data);
+            this->bytes.insert(this->bytes.end(), p, p + size);
+            return;
+        }
+        this->put(std::uint8_t(1));
+        this->put(std::uint32_t(this->fds.size()));
+        this->fds.push_back(get_memfd(data, size));
+    }
+
+    template <typename T>
+    void put_array(const std::vector<T>& v)
+    {
+        this->put_array(v.data(), {std::int64_t(v.size())});
+    }
+
+    std::vector<char> bytes;
+    std::vector<int> fds;
+
+private:
+    static int get_memfd(const void* data, std::size_t size)
+    {
+        int fd = ::memfd_create("matplotlibcpp", MFD_CLOEXEC);
+        if (fd < 0) {
+            throw std::runtime_error(std::string("memfd_create: ") + std::strerror(errno));
+        }
+        const char* p = static_cast<const char*>(data);
+        while (size > 0) {
+            ssize_t n = ::write(fd, p, size);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                ::close(fd);
+                throw std::runtime_error(std::string("write memfd: ") + std::strerror(errno));
+            }
+            p += n;
+            size -= std::size_t(n);
+        }
+        return fd;
+    }
+};
+
+/** Reads a message written by WireWriter. */
+class WireReader
+{
+public:
+    WireReader(const std::vector<char>& bytes) : bytes(bytes), pos(0) {}
+
+    template <typename T>
+    T get()
+    {
+        T value;
+        this->check(sizeof(T));
+        std::memcpy(&value, this->bytes.data() + this->pos, sizeof(T));
+        this->pos += sizeof(T);
+        return value;
+    }
+
+    std::string get_string()
+    {
+        std::size_t n = this->get<std::uint32_t>();
+        this->check(n);
+        std::string s(this->bytes.data() + this->pos, n);
+        this->pos += n;
+        return s;
+    }
+
+    const char* get_bytes(std::size_t n)
+    {
+        this->check(n);
+        const char* p = this->bytes.data() + this->pos;
+        this->pos += n;
+        return p;
+    }
+
+    // bytes not read yet
+    std::size_t remaining() const
+    {
+        return this->bytes.size() - this->pos;
+    }
+
+private:
+    void check(std::size_t n) const
+    {
+        if (this->pos + n > this->bytes.size()) {
+            throw std::runtime_error("truncated message");
+        }
+    }
+
+    const std::vector<char>& bytes;
+    std::size_t pos;
+};
+
+// Maximum number of file descriptors of a frame.
+const std::size_t wire_max_fds = 64;
+
+// Maximum nesting of lists in a value.
+const int wire_max_depth = 32;
+
+/**
+ * @brief Sends a frame, the file descriptors go with its first byte.
+ */
+inline void send_frame(int sock, const WireWriter& message)
+{
+    if (message.fds.size() > wire_max_fds) {
+        throw std::runtime_error("too many arrays in one call");
+    }
+    std::uint32_t length = std::uint32_t(message.bytes.size());
+    std::vector<char> frame(sizeof(length) + message.bytes.size());
+    std::memcpy(frame.data(), &length, sizeof(length));
+    std::copy(message.bytes.begin(), message.bytes.end(), frame.begin() + sizeof(length));
+
+    struct iovec iov;
+    iov.iov_base = frame.data();
+    iov.iov_len  = frame.size();
+    struct msghdr msg;
+    std::memset(&msg, 0, sizeof(msg));
+    msg.msg_iov    = &iov;
+    msg.msg_iovlen = 1;
+    std::vector<char> control;
+    if (!message.fds.empty()) {
+        control.resize(CMSG_SPACE(sizeof(int) * message.fds.size()));
+        msg.msg_control       = control.data();
+        msg.msg_controllen    = control.size();
+        struct cmsghdr* cmsg  = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level      = SOL_SOCKET;
+        cmsg->cmsg_type       = SCM_RIGHTS;
+        cmsg->cmsg_len        = CMSG_LEN(sizeof(int) * message.fds.size());
+        std::memcpy(CMSG_DATA(cmsg), message.fds.data(), sizeof(int) * message.fds.size());
+    }
+
+    std::size_t sent = 0;
+    while (sent < frame.size()) {
+        ssize_t n = sent == 0 ? ::sendmsg(sock, &msg, MSG_NOSIGNAL)
+                              : ::send(sock, frame.data() + sent, frame.size() - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            throw std::runtime_error(std::string("send: ") + std::strerror(errno));
+        }
+        sent += std::size_t(n);
+    }
+}
+
+/**
+ * @brief Receives a frame and its file descriptors, returns false when the peer closed the connection.
+ */
+inline bool recv_frame(int sock, std::vector<char>& bytes, std::vector<int>& fds)
+{
+    std::uint32_t length;
+    struct iovec iov;
+    iov.iov_base = &length;
+    iov.iov_len  = sizeof(length);
+    std::vector<char> control(CMSG_SPACE(sizeof(int) * wire_max_fds));
+    struct msghdr msg;
+    std::memset(&msg, 0, sizeof(msg));
+    msg.msg_iov        = &iov;
+    msg.msg_iovlen     = 1;
+    msg.msg_control    = control.data();
+    msg.msg_controllen = control.size();
+
+    ssize_t n;
+    do {
+        n = ::recvmsg(sock, &msg, MSG_WAITALL | MSG_CMSG_CLOEXEC);
+    } while (n < 0 && errno == EINTR);
+    if (n == 0) {
+        return false;
+    }
+    if (n != ssize_t(sizeof(length))) {
+        throw std::runtime_error(std::string("recvmsg: ") + (n < 0 ? std::strerror(errno) : "short read"));
+    }
+    fds.clear();
+    for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+            std::size_t count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            const int* data   = reinterpret_cast<const int*>(CMSG_DATA(cmsg));
+            fds.insert(fds.end(), data, data + count);
+        }
+    }
+
+    bytes.resize(length);
+    std::size_t received = 0;
+    while (received < length) {
+        n = ::recv(sock, bytes.data() + received, length - received, 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            throw std::runtime_error("connection closed in the middle of a frame");
+        }
+        received += std::size_t(n);
+    }
+    return true;
+}
+
+/** Socket of the plot server: $MATPLOTLIBCPP_SOCKET, else in $XDG_RUNTIME_DIR, else in /tmp. */
+inline std::string get_socket_path()
+{
+    if (const char* path = std::getenv("MATPLOTLIBCPP_SOCKET")) {
+        return path;
+    }
+    if (const char* dir = std::getenv("XDG_RUNTIME_DIR")) {
+        return std::string(dir) + "/matplotlibcpp.sock";
+    }
+    return "/tmp/matplotlibcpp-" + std::to_string(::getuid()) + ".sock";
+}
+
+inline sockaddr_un get_socket_address(const std::string& path)
+{
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("socket path too long: " + path);
+    }
+    std::strcpy(address.sun_path, path.c_str());
+    return address;
+}
+}  // namespace detail
+}  // namespace matplotlibcpp
+
+#endif  // !__PLT_IPC_HPP__
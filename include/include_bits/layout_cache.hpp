@@ -0,0 +1,282 @@
+#ifndef __PLT_LAYOUT_CACHE_HPP__
+#define __PLT_LAYOUT_CACHE_HPP__
+
+#include <unordered_map>
+#include "render_cache.hpp"
+
+namespace matplotlibcpp
+{
+namespace detail
+{
+/** Running hash of the structure of a figure, as seen by tight_layout.
+ * Python objects are hashed with their __hash__, so a key is only valid in the current process.
+ */
+class LayoutKey
+{
+public:
+    explicit LayoutKey(std::uint64_t seed = 0) : state(seed) {}
+
+    void add(std::uint64_t value)
+    {
+        this->state = mix(this->state + hash_prime2) ^ value;
+    }
+
+    void add(double value)
+    {
+        std::uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        this->add(bits);
+    }
+
+    void add(PyObject* value)
+    {
+        Py_hash_t h = PyObject_Hash(value);
+        if (h == -1) {
+            throw std::runtime_error("LayoutKey: unhashable value");
+        }
+        this->add(std::uint64_t(h));
+    }
+
+    /**
+     * @brief Adds the length of the text, the hash of its font and its rotation, or 0 if it is hidden.
+     */
+    void add_text(PyObject* text, bool with_string)
+    {
+        NewRef visible = call(text, "get_visible");
+        NewRef string  = call(text, "get_text");
+        if (visible != Py_True || PyUnicode_GetLength(string) == 0) {
+            this->add(std::uint64_t(0));
+            return;
+        }
+        if (with_string) {
+            this->add((PyObject*)string);
+        } else {
+            this->add(std::uint64_t(PyUnicode_GetLength(string)));
+        }
+        NewRef font     = call(text, "get_fontproperties");
+        NewRef rotation = call(text, "get_rotation");
+        this->add((PyObject*)font);
+        this->add(PyFloat_AsDouble(rotation));
+    }
+
+    std::uint64_t get() const
+    {
+        return mix(this->state);
+    }
+
+    // obj.name(), which must not fail
+    static NewRef call(PyObject* obj, const char* name)
+    {
+        PyObject* res = PyObject_CallMethod(obj, name, nullptr);
+        if (!res) {
+            throw std::runtime_error(std::string("Call failed: ") + name);
+        }
+        return res;
+    }
+
+private:
+    std::uint64_t state;
+};
+
+// rcParams that tight_layout reads besides the fonts of the texts.
+inline const std::vector<std::string>& get_layout_rcparams()
+{
+    static const std::vector<std::string> keys{
+        "axes.titlepad",    "axes.labelpad",    "xtick.major.pad",  "ytick.major.pad",  "xtick.major.size",
+        "ytick.major.size", "xtick.minor.pad",  "ytick.minor.pad",  "xtick.minor.size", "ytick.minor.size",
+        "xtick.direction",  "ytick.direction",  "text.usetex",      "axes.titley",      "figure.subplot.left",
+        "figure.subplot.right", "figure.subplot.bottom", "figure.subplot.top", "figure.subplot.wspace",
+        "figure.subplot.hspace"};
+    return keys;
+}
+
+/**
+ * @brief Key of the layout of fig: figure size and dpi, grid of every axes, titles, axis labels,
+ * tick label lengths, legend texts and the fonts of all of them.
+ */
+inline std::uint64_t get_layout_key(PyObject* fig, PyObject* rcparams)
+{
+    LayoutKey key(0x6C61796F7574ULL);
+    NewRef size = LayoutKey::call(fig, "get_size_inches");
+    NewRef size_list = PySequence_List(size);
+    for (Py_ssize_t k = 0; k < PyList_Size(size_list); ++k) {
+        key.add(PyFloat_AsDouble(PyList_GetItem(size_list, k)));
+    }
+    NewRef dpi = PyObject_GetAttrString(fig, "dpi");
+    key.add(PyFloat_AsDouble(dpi));
+    for (const auto& name : get_layout_rcparams()) {
+        NewRef value = PyMapping_GetItemString(rcparams, name.c_str());
+        if (!value) {
+            PyErr_Clear();
+            continue;
+        }
+        NewRef repr = PyObject_Repr(value);
+        key.add((PyObject*)repr);
+    }
+    for (const char* name : {"_suptitle", "_supxlabel", "_supylabel"}) {
+        NewRef text = PyObject_GetAttrString(fig, name);
+        if (!text) {
+            PyErr_Clear();
+        }
+        if (text && text != Py_None) {
+            key.add_text(text, true);
+        } else {
+            key.add(std::uint64_t(0));
+        }
+    }
+
+    NewRef axes     = PyObject_GetAttrString(fig, "axes");
+    NewRef axes_seq = PySequence_Fast(axes, "axes");
+    key.add(std::uint64_t(PySequence_Fast_GET_SIZE((PyObject*)axes_seq)));
+    for (Py_ssize_t i = 0; i < PySequence_Fast_GET_SIZE((PyObject*)axes_seq); ++i) {
+        PyObject* ax = PySequence_Fast_GET_ITEM((PyObject*)axes_seq, i);
+        NewRef visible = LayoutKey::call(ax, "get_visible");
+        key.add(std::uint64_t(visible == Py_True));
+
+        NewRef spec = LayoutKey::call(ax, "get_subplotspec");
+        if (spec != Py_None) {
+            NewRef geometry = LayoutKey::call(spec, "get_geometry");
+            key.add((PyObject*)geometry);
+            NewRef grid = LayoutKey::call(spec, "get_gridspec");
+            for (const char* ratios : {"get_width_ratios", "get_height_ratios"}) {
+                NewRef value = LayoutKey::call(grid, ratios);
+                NewRef tuple = PySequence_Tuple(value);
+                key.add((PyObject*)tuple);
+            }
+        } else {
+            key.add(std::uint64_t(1));
+        }
+
+        for (const char* name : {"_left_title", "title", "_right_title"}) {
+            NewRef title = PyObject_GetAttrString(ax, name);
+            if (title) {
+                key.add_text(title, true);
+            } else {
+                PyErr_Clear();
+            }
+        }
+
+        for (const char* axis_name : {"xaxis", "yaxis"}) {
+            NewRef axis  = PyObject_GetAttrString(ax, axis_name);
+            NewRef label = PyObject_GetAttrString(axis, "label");
+            key.add_text(label, true);
+            NewRef offset = PyObject_GetAttrString(axis, "offsetText");
+            key.add_text(offset, false);
+            // get_*ticklabels updates the ticks to the current view limits
+            for (const char* labels_name : {"get_majorticklabels", "get_minorticklabels"}) {
+                NewRef labels     = LayoutKey::call(axis, labels_name);
+                NewRef labels_seq = PySequence_Fast(labels, "labels");
+                key.add(std::uint64_t(PySequence_Fast_GET_SIZE((PyObject*)labels_seq)));
+                for (Py_ssize_t k = 0; k < PySequence_Fast_GET_SIZE((PyObject*)labels_seq); ++k) {
+                    key.add_text(PySequence_Fast_GET_ITEM((PyObject*)labels_seq, k), false);
+                }
+            }
+        }
+
+        NewRef legend = LayoutKey::call(ax, "get_legend");
+        if (legend != Py_None) {
+            NewRef texts     = LayoutKey::call(legend, "get_texts");
+            NewRef texts_seq = PySequence_Fast(texts, "texts");
+            for (Py_ssize_t k = 0; k < PySequence_Fast_GET_SIZE((PyObject*)texts_seq); ++k) {
+                key.add_text(PySequence_Fast_GET_ITEM((PyObject*)texts_seq, k), true);
+            }
+            NewRef loc = PyObject_GetAttrString(legend, "_loc");
+            if (!loc) {
+                PyErr_Clear();
+            }
+            key.add(std::uint64_t(loc ? PyObject_Hash(loc) : 0));
+        }
+        key.add(std::uint64_t(legend != Py_None));
+    }
+    return key.get();
+}
+}  // namespace detail
+
+/** Subplot parameters computed by tight_layout, reused for figures of the same structure.
+ * Figures that only differ in their data share a layout as long as their tick labels have the
+ * same lengths, which spares the measurement of every text. At most max_entries layouts are kept,
+ * the least recently used ones are dropped.
+ */
+class LayoutCache
+{
+public:
+    explicit LayoutCache(std::size_t max_entries = 256) : max_entries(max_entries), clock(0), hits(0), misses(0) {}
+
+    /**
+     * @brief tight_layout of fig, or the subplot parameters of an earlier figure with the same key.
+     * @return true if the layout came from the cache.
+     */
+    bool tight_layout(PyObject* fig, PyObject* rcparams)
+    {
+        static const char* names[] = {"left", "right", "bottom", "top", "wspace", "hspace"};
+        std::uint64_t key = detail::get_layout_key(fig, rcparams);
+        auto it           = this->entries.find(key);
+        if (it != this->entries.end()) {
+            it->second.used       = ++this->clock;
+            detail::NewRef kwargs = PyDict_New();
+            for (int k = 0; k < 6; ++k) {
+                detail::set_item(kwargs, names[k], PyFloat_FromDouble(it->second.params[k]));
+            }
+            detail::Load_func("subplots_adjust", fig).call(nullptr, kwargs);
+            ++this->hits;
+            return true;
+        }
+
+        detail::Load_func("tight_layout", fig).call();
+        detail::NewRef params = PyObject_GetAttrString(fig, "subplotpars");
+        Entry entry;
+        entry.used = ++this->clock;
+        for (int k = 0; k < 6; ++k) {
+            detail::NewRef value = PyObject_GetAttrString(params, names[k]);
+            entry.params[k]      = PyFloat_AsDouble(value);
+        }
+        this->entries[key] = entry;
+        ++this->misses;
+        this->evict();
+        return false;
+    }
+
+    std::size_t get_hits() const
+    {
+        return this->hits;
+    }
+
+    std::size_t get_misses() const
+    {
+        return this->misses;
+    }
+
+    void clear()
+    {
+        this->entries.clear();
+    }
+
+private:
+    void evict()
+    {
+        while (this->entries.size() > this->max_entries) {
+            auto oldest = this->entries.begin();
+            for (auto it = this->entries.begin(); it != this->entries.end(); ++it) {
+                if (it->second.used < oldest->second.used) {
+                    oldest = it;
+                }
+            }
+            this->entries.erase(oldest);
+        }
+    }
+
+    struct Entry
+    {
+        double params[6];  // left, right, bottom, top, wspace, hspace
+        std::size_t used;
+    };
+
+    std::unordered_map<std::uint64_t, Entry> entries;
+    std::size_t max_entries;
+    std::size_t clock;
+    std::size_t hits;
+    std::size_t misses;
+};
+}  // namespace matplotlibcpp
+
+#endif  // !__PLT_LAYOUT_CACHE_HPP__
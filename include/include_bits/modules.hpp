@@ -21,21 +21,25 @@ struct Modules
         this->need_init_python = need_init_python;
         if (this->need_init_python)
             Py_Initialize();
-        this->matplotlib = PyImport_Import(PyUnicode_FromString("matplotlib"));
+        if (_import_array() < 0) {
+            throw std::runtime_error("Error loading numpy C-API!");
+        }
+
+        this->matplotlib = PyImport_ImportModule("matplotlib");
         if (!this->matplotlib) {
             throw std::runtime_error("Error loading module matplotlib!");
         }
 
         if (!backend.empty()) {
-            PyObject_CallMethod(matplotlib, "use", "s", backend.c_str());
+            NewRef res = PyObject_CallMethod(matplotlib, "use", "s", backend.c_str());
         }
 
-        this->plt = PyImport_Import(PyUnicode_FromString("matplotlib.pyplot"));
+        this->plt = PyImport_ImportModule("matplotlib.pyplot");
         if (!this->plt) {
             throw std::runtime_error("Error loading module matplotlib.pyplot!");
         }
 
-        this->cm = PyImport_Import(PyUnicode_FromString("matplotlib.cm"));
+        this->cm = PyImport_ImportModule("matplotlib.cm");
         if (!this->cm) {
             throw std::runtime_error("Error loading module matplotlib.cm!");
         }
@@ -2,9 +2,19 @@
 #define __PLT_MATPLOTLIBCPP__
 
 #include <atomic>
+#include <memory>
+#include "audit.hpp"
 #include "axes.hpp"
+#include "colormap.hpp"
+#include "export.hpp"
 #include "figure.hpp"
+#include "figure_pool.hpp"
+#include "layout_cache.hpp"
 #include "modules.hpp"
+#include "profile.hpp"
+#include "render_cache.hpp"
+#include "simplify.hpp"
+#include "tiles.hpp"
 
 namespace matplotlibcpp
 {
@@ -13,6 +23,10 @@ struct PLT
 public:
     static std::atomic_int plt_count;
     detail::Modules modules;
+    detail::FigurePool figure_pool;
+    std::shared_ptr<RenderCache> render_cache;
+    std::shared_ptr<LayoutCache> layout_cache;
+    std::shared_ptr<Profiler> profiler;
 
 private:
     detail::Load_func get_func(const std::string& name, PyObject* module = nullptr)
@@ -22,8 +36,17 @@ private:
         return detail::Load_func(name, module);
     }
 
+    // The recorded calls are forgotten once no figure is being built, figures waiting in the
+    // pool don't count, so the objects they referenced are released.
+    void reset_render_cache()
+    {
+        if (this->render_cache && this->get_fignums().size() == this->figure_pool.idle_size()) {
+            this->render_cache->reset();
+        }
+    }
+
 public:
-    PLT(const std::string& backend = "", bool need_init_python = true)
+    PLT(const std::string& backend = "", bool need_init_python = true) : figure_pool(this->modules)
     {
         if (PLT::plt_count != 0) {
             throw std::runtime_error("plt_count: " + std::to_string(PLT::plt_count));
@@ -34,6 +57,10 @@ public:
 
     ~PLT()
     {
+        this->render_cache.reset();
+        this->layout_cache.reset();
+        this->profiler.reset();
+        this->figure_pool.clear();
         this->modules.release();
     }
 
@@ -56,7 +83,6 @@ public:
         }
         auto func = this->get_func("subplots");
         func.call(args.to_tuple(), kwargs);
-        func.incref_res();
         return {detail::Figure(PyTuple_GetItem(func.res, 0)), detail::Axes(PyTuple_GetItem(func.res, 1), nrows, ncols)};
     }
 
@@ -66,9 +92,9 @@ public:
         if (block) {
             func.call();
         } else {
-            detail::NewRef args = PyDict_New();
-            PyDict_SetItemString(args, "block", Py_False);
-            func.call(args);
+            detail::NewRef kwargs = PyDict_New();
+            PyDict_SetItemString(kwargs, "block", Py_False);
+            func.call(nullptr, kwargs);
         }
     }
 
@@ -111,6 +137,94 @@ public:
         plot(x, y, format, keywords);
     }
 
+    template <typename ScalarX = double, typename ScalarY = double>
+    void plot(const std::vector<ScalarX>& x,
+              const std::vector<ScalarY>& y,
+              const RasterOptions& options,
+              const KeyWords& keywords = {})
+    {
+        this->gca().plot(x, y, options, keywords);
+    }
+
+    /**
+     * @brief plot against timestamps, see TimeStamps.
+     */
+    template <typename ScalarY = double>
+    void plot(const TimeStamps& t,
+              const std::vector<ScalarY>& y,
+              const std::string& format = "",
+              const KeyWords& keywords  = {})
+    {
+        this->gca().plot(t, y, format, keywords);
+    }
+
+    template <typename Clock, typename Duration, typename ScalarY = double>
+    void plot(const std::vector<std::chrono::time_point<Clock, Duration>>& t,
+              const std::vector<ScalarY>& y,
+              const std::string& format = "",
+              const KeyWords& keywords  = {})
+    {
+        this->gca().plot(TimeStamps(t), y, format, keywords);
+    }
+
+    template <typename ScalarY = double>
+    void plot(const Categories& x,
+              const std::vector<ScalarY>& y,
+              const std::string& format = "",
+              const KeyWords& keywords  = {})
+    {
+        this->gca().plot(x, y, format, keywords);
+    }
+
+    template <typename ScalarY = double>
+    void plot(const std::vector<std::string>& x,
+              const std::vector<ScalarY>& y,
+              const std::string& format = "",
+              const KeyWords& keywords  = {})
+    {
+        this->gca().plot(Categories(x), y, format, keywords);
+    }
+
+    void plot(const MemMap& x, const MemMap& y, const std::string& format = "", const KeyWords& keywords = {})
+    {
+        this->gca().plot(x, y, format, keywords);
+    }
+
+    void plot(const MemMap& y, const std::string& format = "", const KeyWords& keywords = {})
+    {
+        this->gca().plot(y, format, keywords);
+    }
+
+    void plot(const ArrayHandle& x, const ArrayHandle& y, const std::string& format = "", const KeyWords& keywords = {})
+    {
+        this->gca().plot(x, y, format, keywords);
+    }
+
+    void plot(const ArrayHandle& y, const std::string& format = "", const KeyWords& keywords = {})
+    {
+        this->gca().plot(y, format, keywords);
+    }
+
+    template <typename ScalarX = double, typename ScalarY = double>
+    detail::Artist plot_many(const std::vector<ScalarX>& x,
+                             const ScalarY* y,
+                             long nlines,
+                             const LineStyles& styles = {},
+                             const KeyWords& keywords = {})
+    {
+        return this->gca().plot_many(x, y, nlines, styles, keywords);
+    }
+
+    template <typename ScalarX = double, typename ScalarY = double>
+    detail::Artist line_collection(const std::vector<std::size_t>& offsets,
+                                   const ScalarX* x,
+                                   const ScalarY* y,
+                                   const LineStyles& styles = {},
+                                   const KeyWords& keywords = {})
+    {
+        return this->gca().line_collection(offsets, x, y, styles, keywords);
+    }
+
     template <typename ScalarX = double, typename ScalarY = double, typename ScalarZ = double>
     void contour(const std::vector<std::vector<ScalarX>>& x,
                  const std::vector<std::vector<ScalarY>>& y,
@@ -119,19 +233,153 @@ public:
     {
         detail::PyContainer args;
         args << x << y << z;
-        auto kwargs                  = detail::get_keywords(keywords);
-        detail::BorrowedRef coolwarm = PyObject_GetAttrString(this->modules.cm, "coolwarm");
-        PyDict_SetItemString(kwargs, "cmap", coolwarm);
+        auto kwargs = detail::get_keywords(keywords);
+        if (keywords.find("cmap") == keywords.end()) {
+            detail::set_item(kwargs, "cmap", PyObject_GetAttrString(this->modules.cm, "coolwarm"));
+        }
         auto func = this->get_func("contour");
         func.call(args.to_tuple(), kwargs);
     }
 
+    template <typename ScalarX = double, typename ScalarY = double, typename ScalarZ = double>
+    detail::Artist contour(const std::vector<ScalarX>& x,
+                           const std::vector<ScalarY>& y,
+                           const ScalarZ* z,
+                           const std::vector<double>& levels,
+                           const ContourOptions& options,
+                           const KeyWords& keywords = {})
+    {
+        return this->gca().contour(x, y, z, levels, options, keywords);
+    }
+
+    template <typename ScalarX = double, typename ScalarY = double, typename ScalarZ = double>
+    detail::Artist contour(const std::vector<ScalarX>& x,
+                           const std::vector<ScalarY>& y,
+                           const ScalarZ* z,
+                           long nlevels,
+                           const ContourOptions& options,
+                           const KeyWords& keywords = {})
+    {
+        return this->gca().contour(x, y, z, nlevels, options, keywords);
+    }
+
+    detail::Artist contour(const ArrayHandle& x,
+                           const ArrayHandle& y,
+                           const ArrayHandle& z,
+                           const KeyWords& keywords = {})
+    {
+        return this->gca().contour(x, y, z, keywords);
+    }
+
+    template <typename Scalar>
+    detail::Image imshow(const Scalar* data, long rows, long cols, const KeyWords& keywords = {})
+    {
+        return this->gca().imshow(data, rows, cols, keywords);
+    }
+
+    template <typename Scalar>
+    detail::Image imshow(const Scalar* data,
+                         long rows,
+                         long cols,
+                         double vmin,
+                         double vmax,
+                         const KeyWords& keywords = {})
+    {
+        return this->gca().imshow(data, rows, cols, vmin, vmax, keywords);
+    }
+
+    detail::Image imshow(const ArrayHandle& data,
+                         double vmin              = NAN,
+                         double vmax              = NAN,
+                         const KeyWords& keywords = {})
+    {
+        return this->gca().imshow(data, vmin, vmax, keywords);
+    }
+
+    detail::Image imshow(const std::uint8_t* data, long rows, long cols, long channels, const KeyWords& keywords = {})
+    {
+        return this->gca().imshow(data, rows, cols, channels, keywords);
+    }
+
+    template <typename Scalar>
+    detail::Image matshow(const Scalar* data,
+                          long rows,
+                          long cols,
+                          double vmin              = NAN,
+                          double vmax              = NAN,
+                          const KeyWords& keywords = {})
+    {
+        return this->gca().matshow(data, rows, cols, vmin, vmax, keywords);
+    }
+
+    template <typename Scalar>
+    detail::Image pcolormesh(const Scalar* data,
+                             long rows,
+                             long cols,
+                             double vmin              = NAN,
+                             double vmax              = NAN,
+                             const KeyWords& keywords = {})
+    {
+        return this->gca().pcolormesh(data, rows, cols, vmin, vmax, keywords);
+    }
+
+    template <typename ScalarX = double, typename ScalarY = double, typename Scalar = double>
+    detail::Image pcolormesh(const std::vector<ScalarX>& x,
+                             const std::vector<ScalarY>& y,
+                             const Scalar* data,
+                             long rows,
+                             long cols,
+                             double vmin              = NAN,
+                             double vmax              = NAN,
+                             const KeyWords& keywords = {})
+    {
+        return this->gca().pcolormesh(x, y, data, rows, cols, vmin, vmax, keywords);
+    }
+
+    inline void colorbar(const detail::Artist& mappable, const KeyWords& keywords = {})
+    {
+        detail::PyContainer args;
+        args << detail::BorrowedRef(mappable.get_artist());
+        auto func = this->get_func("colorbar");
+        func.call(args.to_tuple(), detail::get_keywords(keywords));
+    }
+
+    /**
+     * @brief Colorbar of the current axes for images colored by colormap.
+     */
+    inline void colorbar(const ColorMap& colormap, const KeyWords& keywords = {})
+    {
+        detail::PyContainer args;
+        args << detail::BorrowedRef(colormap.get_mappable().get_artist());
+        auto kwargs = detail::get_keywords(keywords);
+        // the mappable isn't drawn in any axes, the space for the colorbar is taken from the current one
+        auto ax = this->gca();
+        PyDict_SetItemString(kwargs, "ax", ax.get_ax());
+        auto func = this->get_func("colorbar");
+        func.call(args.to_tuple(), kwargs);
+    }
+
+    /**
+     * @brief Labels the lines of a contour set, with fontsize in points if it is positive.
+     */
+    inline void clabel(const detail::Artist& contour_set, double fontsize = 0, const KeyWords& keywords = {})
+    {
+        detail::PyContainer args;
+        args << detail::BorrowedRef(contour_set.get_artist());
+        auto kwargs = detail::get_keywords(keywords);
+        if (fontsize > 0) {
+            detail::set_item(kwargs, "fontsize", PyFloat_FromDouble(fontsize));
+        }
+        auto func = this->get_func("clabel");
+        func.call(args.to_tuple(), kwargs);
+    }
+
     template <typename Scalar = double>
     void spy(const std::vector<std::vector<Scalar>>& x, long markersize = -1, const KeyWords& keywords = {})
     {
         auto kwargs = detail::get_keywords(keywords);
         if (markersize != -1) {
-            PyDict_SetItemString(kwargs, "markersize", PyLong_FromLong(markersize));
+            detail::set_item(kwargs, "markersize", PyLong_FromLong(markersize));
         }
         detail::PyContainer args;
         args << x;
@@ -139,6 +387,22 @@ public:
         func.call(args.to_tuple(), kwargs);
     }
 
+    template <typename Index = long, typename Scalar = double>
+    detail::Artist spy(const CsrMatrix<Index, Scalar>& matrix,
+                       const SpyOptions& options = SpyOptions(),
+                       const KeyWords& keywords  = {})
+    {
+        return this->gca().spy(matrix, options, keywords);
+    }
+
+    template <typename Index = long, typename Scalar = double>
+    detail::Artist spy(const CooMatrix<Index, Scalar>& matrix,
+                       const SpyOptions& options = SpyOptions(),
+                       const KeyWords& keywords  = {})
+    {
+        return this->gca().spy(matrix, options, keywords);
+    }
+
     template <typename ScalarX = double, typename ScalarY = double>
     void stem(const std::vector<ScalarX>& x, const std::vector<ScalarY>& y, const KeyWords& keywords)
     {
@@ -149,6 +413,11 @@ public:
         func.call(args.to_tuple(), detail::get_keywords(keywords));
     }
 
+    void stem(const ArrayHandle& x, const ArrayHandle& y, const KeyWords& keywords = {})
+    {
+        this->gca().stem(x, y, keywords);
+    }
+
     template <typename ScalarX = double, typename ScalarY = double>
     void fill(const std::vector<ScalarX>& x, const std::vector<ScalarY>& y, const KeyWords& keywords)
     {
@@ -168,20 +437,80 @@ public:
         assert(x.size() == y1.size());
         assert(x.size() == y2.size());
         detail::PyContainer args;
-        args << x << y1 << y2;
+        args << detail::get_pyarray(x) << detail::get_pyarray(y1) << detail::get_pyarray(y2);
 
         detail::NewRef kwargs = PyDict_New();
         for (auto&& v : keywords) {
             if (v.first == "alpha") {
-                PyDict_SetItemString(kwargs, v.first.c_str(), PyFloat_FromDouble(std::stod(v.second)));
+                detail::set_item(kwargs, v.first, PyFloat_FromDouble(std::stod(v.second)));
             } else {
-                PyDict_SetItemString(kwargs, v.first.c_str(), PyUnicode_FromString(v.second.c_str()));
+                detail::set_item(kwargs, v.first, PyUnicode_FromString(v.second.c_str()));
             }
         }
         auto func = this->get_func("fill_between");
         func.call(args.to_tuple(), kwargs);
     }
 
+    template <typename ScalarY1 = double, typename ScalarY2 = double>
+    void fill_between(const TimeStamps& t,
+                      const std::vector<ScalarY1>& y1,
+                      const std::vector<ScalarY2>& y2,
+                      const KeyWords& keywords = {})
+    {
+        this->gca().fill_between(t, y1, y2, keywords);
+    }
+
+    template <typename Clock, typename Duration, typename ScalarY1 = double, typename ScalarY2 = double>
+    void fill_between(const std::vector<std::chrono::time_point<Clock, Duration>>& t,
+                      const std::vector<ScalarY1>& y1,
+                      const std::vector<ScalarY2>& y2,
+                      const KeyWords& keywords = {})
+    {
+        this->gca().fill_between(TimeStamps(t), y1, y2, keywords);
+    }
+
+    /**
+     * @brief fill_between with a numeric alpha.
+     */
+    template <typename ScalarX = double, typename ScalarY1 = double, typename ScalarY2 = double>
+    void fill_between(const std::vector<ScalarX>& x,
+                      const std::vector<ScalarY1>& y1,
+                      const std::vector<ScalarY2>& y2,
+                      double alpha,
+                      const KeyWords& keywords = {})
+    {
+        assert(x.size() == y1.size());
+        assert(x.size() == y2.size());
+        detail::PyContainer args;
+        args << detail::get_pyarray(x) << detail::get_pyarray(y1) << detail::get_pyarray(y2);
+        auto kwargs = detail::get_keywords(keywords);
+        detail::set_item(kwargs, "alpha", PyFloat_FromDouble(alpha));
+        auto func = this->get_func("fill_between");
+        func.call(args.to_tuple(), kwargs);
+    }
+
+    void fill_between(const ArrayHandle& x,
+                      const ArrayHandle& y1,
+                      const ArrayHandle& y2,
+                      const KeyWords& keywords = {})
+    {
+        this->gca().fill_between(x, y1, y2, keywords);
+    }
+
+    detail::Artist band(const BandAggregator& aggregator, const KeyWords& keywords = {})
+    {
+        return this->gca().band(aggregator, keywords);
+    }
+
+    template <typename ScalarX = double, typename ScalarY = double>
+    detail::Artist band(const std::vector<ScalarX>& x,
+                        const std::vector<ScalarY>& y,
+                        const BandOptions& options = BandOptions(),
+                        const KeyWords& keywords   = {})
+    {
+        return this->gca().band(x, y, options, keywords);
+    }
+
     /**
      * @brief Add an arrow to the Axes.
 
@@ -194,11 +523,11 @@ public:
         detail::NewRef kwargs = PyDict_New();
         for (auto&& v : keywords) {
             if (v.first == "width" || v.first == "head_width" || v.first == "head_length" || v.first == "overhang") {
-                PyDict_SetItemString(kwargs, v.first.c_str(), PyFloat_FromDouble(std::stod(v.second)));
+                detail::set_item(kwargs, v.first, PyFloat_FromDouble(std::stod(v.second)));
             } else if (v.first == "length_includes_head" || v.first == "head_starts_at_zero") {
                 PyDict_SetItemString(kwargs, v.first.c_str(), v.second == "True" ? Py_True : Py_False);
             } else {
-                PyDict_SetItemString(kwargs, v.first.c_str(), PyUnicode_FromString(v.second.c_str()));
+                detail::set_item(kwargs, v.first, PyUnicode_FromString(v.second.c_str()));
             }
         }
         auto func = this->get_func("arrow");
@@ -213,9 +542,9 @@ public:
               bool cumulative   = false)
     {
         detail::NewRef kwargs = PyDict_New();
-        PyDict_SetItemString(kwargs, "bins", PyLong_FromLong(bins));
-        PyDict_SetItemString(kwargs, "color", PyUnicode_FromString(color.c_str()));
-        PyDict_SetItemString(kwargs, "alpha", PyFloat_FromDouble(alpha));
+        detail::set_item(kwargs, "bins", PyLong_FromLong(bins));
+        detail::set_item(kwargs, "color", PyUnicode_FromString(color.c_str()));
+        detail::set_item(kwargs, "alpha", PyFloat_FromDouble(alpha));
         PyDict_SetItemString(kwargs, "cumulative", cumulative ? Py_True : Py_False);
 
         detail::PyContainer args;
@@ -224,6 +553,16 @@ public:
         func.call(args.to_tuple(), kwargs);
     }
 
+    void hist(const MemMap& y, long bins = 10, std::string color = "b", double alpha = 1.0, bool cumulative = false)
+    {
+        this->gca().hist(y, bins, color, alpha, cumulative);
+    }
+
+    void hist(const ArrayHandle& y, long bins = 10, const KeyWords& keywords = {})
+    {
+        this->gca().hist(y, bins, keywords);
+    }
+
     template <typename ScalarX = double, typename ScalarY = double>
     void scatter(const std::vector<ScalarX>& x,
                  const std::vector<ScalarY>& y,
@@ -232,35 +571,113 @@ public:
     {
         assert(x.size() == y.size());
         detail::PyContainer args;
-        args << x << y;
+        args << detail::get_pyarray(x) << detail::get_pyarray(y);
         auto kwargs = detail::get_keywords(keywords);
-        PyDict_SetItemString(kwargs, "s", PyLong_FromLong(s));
+        detail::set_item(kwargs, "s", PyFloat_FromDouble(s));
         auto func = this->get_func("scatter");
         func.call(args.to_tuple(), kwargs);
     }
 
+    template <typename ScalarX = double, typename ScalarY = double, typename ScalarS = double>
+    void scatter(const std::vector<ScalarX>& x,
+                 const std::vector<ScalarY>& y,
+                 const std::vector<ScalarS>& s,
+                 const KeyWords& keywords = {})
+    {
+        this->gca().scatter(x, y, s, keywords);
+    }
+
+    template <typename ScalarX = double, typename ScalarY = double, typename ScalarS = double, typename ScalarC = double>
+    void scatter(const std::vector<ScalarX>& x,
+                 const std::vector<ScalarY>& y,
+                 const std::vector<ScalarS>& s,
+                 const std::vector<ScalarC>& c,
+                 double vmin              = NAN,
+                 double vmax              = NAN,
+                 const KeyWords& keywords = {})
+    {
+        this->gca().scatter(x, y, s, c, vmin, vmax, keywords);
+    }
+
+    template <typename ScalarX = double, typename ScalarY = double, typename ScalarS = double, typename Channel>
+    void scatter(const std::vector<ScalarX>& x,
+                 const std::vector<ScalarY>& y,
+                 const std::vector<ScalarS>& s,
+                 const std::vector<std::array<Channel, 4>>& rgba,
+                 const KeyWords& keywords = {})
+    {
+        this->gca().scatter(x, y, s, rgba, keywords);
+    }
+
+    template <typename ScalarX = double, typename ScalarY = double>
+    void scatter(const std::vector<ScalarX>& x,
+                 const std::vector<ScalarY>& y,
+                 const RasterOptions& options,
+                 const KeyWords& keywords = {})
+    {
+        this->gca().scatter(x, y, options, keywords);
+    }
+
+    template <typename ScalarY = double>
+    void scatter(const TimeStamps& t, const std::vector<ScalarY>& y, double s = 1.0, const KeyWords& keywords = {})
+    {
+        this->gca().scatter(t, y, s, keywords);
+    }
+
+    template <typename Clock, typename Duration, typename ScalarY = double>
+    void scatter(const std::vector<std::chrono::time_point<Clock, Duration>>& t,
+                 const std::vector<ScalarY>& y,
+                 double s                 = 1.0,
+                 const KeyWords& keywords = {})
+    {
+        this->gca().scatter(TimeStamps(t), y, s, keywords);
+    }
+
+    template <typename ScalarY = double>
+    void scatter(const Categories& x, const std::vector<ScalarY>& y, double s = 1.0, const KeyWords& keywords = {})
+    {
+        this->gca().scatter(x, y, s, keywords);
+    }
+
+    template <typename ScalarY = double>
+    void scatter(const std::vector<std::string>& x,
+                 const std::vector<ScalarY>& y,
+                 double s                 = 1.0,
+                 const KeyWords& keywords = {})
+    {
+        this->gca().scatter(Categories(x), y, s, keywords);
+    }
+
+    void scatter(const ArrayHandle& x, const ArrayHandle& y, double s = 1.0, const KeyWords& keywords = {})
+    {
+        this->gca().scatter(x, y, s, keywords);
+    }
+
+    void scatter(const MemMap& x, const MemMap& y, const double s = 1.0, const KeyWords& keywords = {})
+    {
+        this->gca().scatter(x, y, s, keywords);
+    }
+
     template <typename Scalar = double>
     void boxplot(const std::vector<std::vector<Scalar>>& data,
                  const std::vector<std::string>& labels = {},
                  const KeyWords& keywords               = {})
     {
-        detail::PyContainer args;
-        args << data;
-        auto kwargs = detail::get_keywords(keywords);
-        if (!labels.empty() && labels.size() == data.size()) {
-            PyDict_SetItemString(kwargs, "labels", detail::get_pylist(labels));
-        }
-        auto func = this->get_func("boxplot");
-        func.call(args.to_tuple(), kwargs);
+        this->gca().boxplot(data, labels, keywords);
     }
 
     template <typename Scalar = double>
     void boxplot(const std::vector<Scalar>& data, const KeyWords& keywords = {})
     {
-        detail::PyContainer args;
-        args << data;
-        auto func = this->get_func("boxplot");
-        func.call(args.to_tuple(), detail::get_keywords(keywords));
+        this->gca().boxplot(std::vector<std::vector<Scalar>>{data}, {}, keywords);
+    }
+
+    template <typename Scalar = double>
+    void violinplot(const std::vector<std::vector<Scalar>>& data,
+                    const std::vector<std::string>& labels = {},
+                    const KeyWords& keywords               = {})
+    {
+        this->gca().violinplot(data, labels, keywords);
     }
 
     detail::Axes twinx(detail::Axes ax = detail::Axes())
@@ -268,13 +685,11 @@ public:
         auto func = this->get_func("twinx");
         if (ax.get_ax() == nullptr) {
             func.call();
-            func.incref_res();
         } else {
-            detail::NewRef args = PyTuple_New(1);
-            PyTuple_SetItem(args, 0, ax.get_ax());
-            func.call(args);
+            detail::PyContainer args;
+            args << detail::BorrowedRef(ax.get_ax());
+            func.call(args.to_tuple());
         }
-        func.incref_res();
         return detail::Axes(func.res);
     }
 
@@ -283,13 +698,11 @@ public:
         auto func = this->get_func("twiny");
         if (ax.get_ax() == nullptr) {
             func.call();
-            func.incref_res();
         } else {
-            detail::NewRef args = PyTuple_New(1);
-            PyTuple_SetItem(args, 0, ax.get_ax());
-            func.call(args);
+            detail::PyContainer args;
+            args << detail::BorrowedRef(ax.get_ax());
+            func.call(args.to_tuple());
         }
-        func.incref_res();
         return detail::Axes(func.res);
     }
 
@@ -304,9 +717,9 @@ public:
         detail::PyContainer args;
         args << x << y;
         auto kwargs = detail::get_keywords(keywords);
-        PyDict_SetItemString(kwargs, "ec", PyUnicode_FromString(ec.c_str()));
-        PyDict_SetItemString(kwargs, "ls", PyUnicode_FromString(ls.c_str()));
-        PyDict_SetItemString(kwargs, "lw", PyFloat_FromDouble(lw));
+        detail::set_item(kwargs, "ec", PyUnicode_FromString(ec.c_str()));
+        detail::set_item(kwargs, "ls", PyUnicode_FromString(ls.c_str()));
+        detail::set_item(kwargs, "lw", PyFloat_FromDouble(lw));
         auto func = this->get_func("bar");
         func.call(args.to_tuple(), kwargs);
     }
@@ -338,18 +751,55 @@ public:
         detail::PyContainer args;
         args << x << y;
         auto kwargs = detail::get_keywords(keywords);
-        PyDict_SetItemString(kwargs, "ec", PyUnicode_FromString(ec.c_str()));
-        PyDict_SetItemString(kwargs, "ls", PyUnicode_FromString(ls.c_str()));
-        PyDict_SetItemString(kwargs, "lw", PyFloat_FromDouble(lw));
+        detail::set_item(kwargs, "ec", PyUnicode_FromString(ec.c_str()));
+        detail::set_item(kwargs, "ls", PyUnicode_FromString(ls.c_str()));
+        detail::set_item(kwargs, "lw", PyFloat_FromDouble(lw));
         auto func = this->get_func("barh");
         func.call(args.to_tuple(), kwargs);
     }
 
+    /**
+     * @brief Bars of categories, see Categories.
+     */
+    template <typename Scalar = double>
+    void bar(const Categories& x, const std::vector<Scalar>& height, const KeyWords& keywords = {})
+    {
+        this->gca().bar(x, height, keywords);
+    }
+
+    template <typename Scalar = double>
+    void bar(const std::vector<std::string>& x, const std::vector<Scalar>& height, const KeyWords& keywords = {})
+    {
+        this->gca().bar(Categories(x), height, keywords);
+    }
+
+    void bar(const ArrayHandle& x, const ArrayHandle& height, const KeyWords& keywords = {})
+    {
+        this->gca().bar(x, height, keywords);
+    }
+
+    void barh(const ArrayHandle& y, const ArrayHandle& width, const KeyWords& keywords = {})
+    {
+        this->gca().barh(y, width, keywords);
+    }
+
+    template <typename Scalar = double>
+    void barh(const Categories& y, const std::vector<Scalar>& width, const KeyWords& keywords = {})
+    {
+        this->gca().barh(y, width, keywords);
+    }
+
+    template <typename Scalar = double>
+    void barh(const std::vector<std::string>& y, const std::vector<Scalar>& width, const KeyWords& keywords = {})
+    {
+        this->gca().barh(Categories(y), width, keywords);
+    }
+
     inline void subplots_adjust(const std::map<std::string, double>& keywords = {})
     {
         detail::NewRef kwargs = PyDict_New();
         for (std::map<std::string, double>::const_iterator it = keywords.begin(); it != keywords.end(); ++it) {
-            PyDict_SetItemString(kwargs, it->first.c_str(), PyFloat_FromDouble(it->second));
+            detail::set_item(kwargs, it->first, PyFloat_FromDouble(it->second));
         }
         auto func = this->get_func("subplots_adjust");
         func.call(nullptr, kwargs);
@@ -381,11 +831,22 @@ public:
     {
         assert(x.size() == y.size() && x.size() == u.size() && u.size() == w.size());
         detail::PyContainer args;
-        args << x << y << u << w;
+        args << detail::get_pyarray(x) << detail::get_pyarray(y) << detail::get_pyarray(u) << detail::get_pyarray(w);
         auto func = this->get_func("quiver");
         func.call(args.to_tuple(), detail::get_keywords(keywords));
     }
 
+    template <typename ScalarX = double, typename ScalarY = double, typename ScalarU = double, typename ScalarV = double>
+    detail::Artist quiver(const std::vector<ScalarX>& x,
+                          const std::vector<ScalarY>& y,
+                          const ScalarU* u,
+                          const ScalarV* v,
+                          const QuiverOptions& options,
+                          const KeyWords& keywords = {})
+    {
+        return this->gca().quiver(x, y, u, v, options, keywords);
+    }
+
     template <typename ScalarX = double, typename ScalarY = double>
     void stem(const std::vector<ScalarX>& x, const std::vector<ScalarY>& y, const std::string& s = "")
     {
@@ -451,6 +912,11 @@ public:
         func.call(args.to_tuple(), kwargs);
     }
 
+    void errorbar(const ArrayHandle& x, const ArrayHandle& y, const ArrayHandle& yerr, const KeyWords& keywords = {})
+    {
+        this->gca().errorbar(x, y, yerr, keywords);
+    }
+
     void text(double x, double y, const std::string& s = "")
     {
         detail::PyContainer args;
@@ -459,6 +925,17 @@ public:
         func.call(args.to_tuple());
     }
 
+    template <typename ScalarX = double, typename ScalarY = double>
+    std::vector<std::size_t> texts(const std::vector<ScalarX>& x,
+                                   const std::vector<ScalarY>& y,
+                                   const std::vector<std::string>& labels,
+                                   const TextStyles& styles   = {},
+                                   const TextOptions& options = TextOptions(),
+                                   const KeyWords& keywords   = {})
+    {
+        return this->gca().texts(x, y, labels, styles, options, keywords);
+    }
+
     inline long figure(long number = -1)
     {
         auto func = this->get_func("figure");
@@ -486,8 +963,7 @@ public:
     detail::Axes gca(const KeyWords& keywords = {})
     {
         auto func = this->get_func("gca");
-        func.call(detail::get_keywords(keywords));
-        func.incref_res();
+        func.call(nullptr, detail::get_keywords(keywords));
         return detail::Axes(func.res);
     }
 
@@ -495,7 +971,6 @@ public:
     {
         auto func = this->get_func("gcf");
         func.call();
-        func.incref_res();
         return detail::Figure(func.res);
     }
 
@@ -503,7 +978,7 @@ public:
     {
         detail::NewRef kwargs = PyDict_New();
         PyDict_SetItemString(kwargs, "figsize", detail::get_pylist(figsize));
-        PyDict_SetItemString(kwargs, "dpi", PyLong_FromSize_t(dpi));
+        detail::set_item(kwargs, "dpi", PyLong_FromSize_t(dpi));
         auto func = this->get_func("figure");
         func.call(nullptr, kwargs);
     }
@@ -520,8 +995,7 @@ public:
         args << ratio;
         auto gca = this->get_func("gca");
         gca.call();
-        detail::BorrowedRef set_aspect = PyObject_GetAttrString(gca.res, "set_aspect");
-        detail::DecRefDtor res         = PyObject_CallObject(set_aspect, args.to_tuple());
+        detail::Load_func("set_aspect", gca.res).call(args.to_tuple());
     }
 
     inline void set_aspect_equal()
@@ -530,8 +1004,7 @@ public:
         PyTuple_SetItem(args, 0, PyUnicode_FromString("equal"));
         auto gca = this->get_func("gca");
         gca.call();
-        detail::BorrowedRef set_aspect = PyObject_GetAttrString(gca.res, "set_aspect");
-        detail::DecRefDtor res         = PyObject_CallObject(set_aspect, args);
+        detail::Load_func("set_aspect", gca.res).call(args);
     }
 
     void ylim(double left, double right)
@@ -575,9 +1048,9 @@ public:
     {
         assert(labels.size() == 0 || ticks.size() == labels.size());
         detail::PyContainer args;
-        args << ticks;
+        args << detail::get_pyarray(ticks);
         if (!labels.empty()) {
-            args << labels;
+            args << detail::get_unicode_array(labels);
         }
         auto func = this->get_func("xticks");
         func.call(args.to_tuple(), detail::get_keywords(keywords));
@@ -590,9 +1063,9 @@ public:
     {
         assert(labels.size() == 0 || ticks.size() == labels.size());
         detail::PyContainer args;
-        args << ticks;
+        args << detail::get_pyarray(ticks);
         if (!labels.empty()) {
-            args << labels;
+            args << detail::get_unicode_array(labels);
         }
         auto func = this->get_func("yticks");
         func.call(args.to_tuple(), detail::get_keywords(keywords));
@@ -698,9 +1171,9 @@ public:
         detail::NewRef kwargs = PyDict_New();
         for (auto it = keywords.begin(); it != keywords.end(); ++it) {
             if (it->first == "linewidth" || it->first == "alpha") {
-                PyDict_SetItemString(kwargs, it->first.c_str(), PyFloat_FromDouble(std::stod(it->second)));
+                detail::set_item(kwargs, it->first, PyFloat_FromDouble(std::stod(it->second)));
             } else {
-                PyDict_SetItemString(kwargs, it->first.c_str(), PyUnicode_FromString(it->second.c_str()));
+                detail::set_item(kwargs, it->first, PyUnicode_FromString(it->second.c_str()));
             }
         }
         auto func = this->get_func("axvspan");
@@ -735,6 +1208,7 @@ public:
     {
         auto func = this->get_func("close");
         func.call();
+        this->reset_render_cache();
     }
 
     inline void xkcd()
@@ -759,15 +1233,159 @@ public:
 
     inline void savefig(const std::string& filename, long dpi = 100, const std::string format = "")
     {
+        std::string cached;
+        if (this->render_cache) {
+            cached = this->render_cache->get_path(dpi, detail::get_format(filename, format));
+            if (this->render_cache->fetch(cached, filename)) {
+                return;
+            }
+        }
         detail::PyContainer args;
         args << filename;
         detail::NewRef kwargs = PyDict_New();
         if (dpi > 0)
-            PyDict_SetItemString(kwargs, "dpi", PyLong_FromLong(dpi));
+            detail::set_item(kwargs, "dpi", PyLong_FromLong(dpi));
         if (!format.empty())
-            PyDict_SetItemString(kwargs, "format", PyUnicode_FromString(format.c_str()));
+            detail::set_item(kwargs, "format", PyUnicode_FromString(format.c_str()));
         auto func = this->get_func("savefig");
         func.call(args.to_tuple(), kwargs);
+        if (!cached.empty()) {
+            this->render_cache->store(cached, filename);
+        }
+    }
+
+    /**
+     * @brief savefig of the current figure with simplified lines and rasterized large artists,
+     * keeps SVG and PDF files small for series of millions of points.
+     */
+    inline void savefig(const std::string& filename,
+                        const VectorOptions& options,
+                        long dpi                  = 100,
+                        const std::string& format = "")
+    {
+        auto fig = this->gcf();
+        detail::VectorExport vector_export(fig.get_fig(), options, dpi);
+        this->savefig(filename, dpi, format);
+    }
+
+    /**
+     * @brief Saves the current figure to every target from one layout pass.
+     *
+     * Raster targets of the same dpi share one Agg render, their encoding and writing runs on
+     * nthreads background threads (0: one per core) while the vector formats are drawn.
+     */
+    inline void savefig_multi(const std::vector<SaveTarget>& targets, unsigned nthreads = 0)
+    {
+        auto fig = this->gcf();
+        detail::savefig_multi(fig.get_fig(), targets, nthreads);
+    }
+
+    inline void savefig_multi(const detail::Figure& fig, const std::vector<SaveTarget>& targets, unsigned nthreads = 0)
+    {
+        detail::savefig_multi(fig.get_fig(), targets, nthreads);
+    }
+
+    /**
+     * @brief Renders the current figure at dpi as a directory of tiles with an index.json,
+     * for canvases too large for one Agg buffer. Tiles are rendered by forked processes, or in
+     * this process while other python threads run; no C++ thread may run meanwhile.
+     */
+    inline std::vector<Tile> savefig_tiles(const std::string& directory,
+                                           long dpi,
+                                           const TileOptions& options = TileOptions())
+    {
+        auto fig = this->gcf();
+        return detail::savefig_tiles(fig.get_fig(), directory, dpi, options);
+    }
+
+    /**
+     * @brief A figure of the layout taken from the figure pool, it becomes the current figure.
+     *
+     * Figures are handed back with release_figure or savefig(fig, ...), they are then cleared
+     * back to the state of a new figure but keep the axes of the layout.
+     */
+    inline std::pair<detail::Figure, detail::Axes> acquire_figure(const FigureLayout& layout = FigureLayout())
+    {
+        return this->figure_pool.acquire(layout);
+    }
+
+    inline void release_figure(const detail::Figure& fig)
+    {
+        if (!this->figure_pool.release(fig)) {
+            throw std::runtime_error("figure was not acquired from the figure pool");
+        }
+        this->reset_render_cache();
+    }
+
+    /**
+     * @brief Saves fig and, if it comes from the figure pool, returns it to the pool.
+     */
+    inline void savefig(const detail::Figure& fig,
+                        const std::string& filename,
+                        long dpi                  = 100,
+                        const std::string& format = "")
+    {
+        std::string cached;
+        if (this->render_cache) {
+            cached = this->render_cache->get_path(dpi, detail::get_format(filename, format), fig.get_fig());
+        }
+        if (cached.empty() || !this->render_cache->fetch(cached, filename)) {
+            fig.savefig(filename, dpi, format);
+            if (!cached.empty()) {
+                this->render_cache->store(cached, filename);
+            }
+        }
+        if (this->figure_pool.release(fig)) {
+            this->reset_render_cache();
+        }
+    }
+
+    /**
+     * @brief Caches the files written by savefig in directory, keyed by a hash of the calls that built the figure.
+     *
+     * A later savefig of an identical figure, e.g. in the next run of the same program on the
+     * same data, copies the cached file instead of rendering. The hash covers every call with
+     * its arguments and the bytes of all arrays, large arrays are hashed on nthreads threads.
+     * Arrays still alive at savefig are hashed again, so data changed in place behind a
+     * zero-copy view or an ArrayHandle is not served from a stale file.
+     * Must be enabled before any figure is created.
+     */
+    inline void enable_render_cache(const std::string& directory,
+                                    std::size_t max_bytes = std::size_t(1) << 30,
+                                    unsigned nthreads     = 0)
+    {
+        if (!this->get_fignums().empty()) {
+            throw std::runtime_error("enable_render_cache: figures already exist");
+        }
+        detail::NewRef version = PyObject_GetAttrString(this->modules.matplotlib, "__version__");
+        auto backend           = this->get_func("get_backend");
+        backend.call();
+        this->render_cache.reset(new RenderCache(
+            directory, max_bytes, nthreads, std::string(PyUnicode_AsUTF8(version)) + PyUnicode_AsUTF8(backend.res)));
+    }
+
+    inline void disable_render_cache()
+    {
+        this->render_cache.reset();
+    }
+
+    inline std::vector<long> get_fignums()
+    {
+        auto func = this->get_func("get_fignums");
+        func.call();
+        std::vector<long> numbers;
+        for (Py_ssize_t i = 0; i < PyList_Size(func.res); ++i) {
+            numbers.push_back(PyLong_AsLong(PyList_GetItem(func.res, i)));
+        }
+        return numbers;
+    }
+
+    /**
+     * @brief Bounds the number of idle pooled figures and the memory of their canvases.
+     */
+    inline void set_figure_pool_limits(std::size_t max_figures, std::size_t max_bytes = std::size_t(256) << 20)
+    {
+        this->figure_pool.set_limits(max_figures, max_bytes);
     }
 
     inline void rcparams(const KeyWords& keywords = {})
@@ -775,15 +1393,16 @@ public:
         detail::NewRef kwargs = PyDict_New();
         for (auto it = keywords.begin(); it != keywords.end(); ++it) {
             if ("text.usetex" == it->first)
-                PyDict_SetItemString(kwargs, it->first.c_str(), PyLong_FromLong(std::stoi(it->second.c_str())));
+                detail::set_item(kwargs, it->first, PyLong_FromLong(std::stoi(it->second.c_str())));
             else
-                PyDict_SetItemString(kwargs, it->first.c_str(), PyUnicode_FromString(it->second.c_str()));
+                detail::set_item(kwargs, it->first, PyUnicode_FromString(it->second.c_str()));
         }
         auto rcparams = this->get_func("rcParams");
 
-        detail::BorrowedRef update = PyObject_GetAttrString(rcparams.fn, "update");
+        detail::NewRef update      = PyObject_GetAttrString(rcparams.fn, "update");
         detail::NewRef empty_tuple = PyTuple_New(0);
-        detail::DecRefDtor res     = PyObject_Call(update, empty_tuple, kwargs);
+        detail::notify_call(update, empty_tuple, kwargs);
+        detail::DecRefDtor res = PyObject_Call(update, empty_tuple, kwargs);
         if (!res)
             throw std::runtime_error("Call to rcParams.update() failed.");
     }
@@ -830,9 +1449,49 @@ public:
 
     inline void tight_layout()
     {
+        if (this->layout_cache) {
+            auto fig                 = this->gcf();
+            detail::NewRef rcparams = PyObject_GetAttrString(this->modules.plt, "rcParams");
+            this->layout_cache->tight_layout(fig.get_fig(), rcparams);
+            return;
+        }
         auto func = this->get_func("tight_layout");
         func.call();
     }
+
+    /**
+     * @brief Makes tight_layout reuse the subplot parameters of earlier figures with the same structure.
+     *
+     * The key covers the figure size, the grid of every axes, titles, axis labels, legend texts,
+     * the lengths of the tick labels and the fonts of all of them, so figures that only differ in
+     * their data skip the measurement of their texts.
+     */
+    inline void enable_layout_cache(std::size_t max_entries = 256)
+    {
+        this->layout_cache.reset(new LayoutCache(max_entries));
+    }
+
+    inline void disable_layout_cache()
+    {
+        this->layout_cache.reset();
+    }
+
+    /**
+     * @brief Runs cProfile during the calls of the given functions, e.g. draw, savefig and tight_layout.
+     *
+     * Other calls run without the profiler. The results are read from profiler, as the hotspots
+     * or as collapsed stacks for a flame graph.
+     */
+    inline void enable_profiling(const std::vector<std::string>& functions = {"draw", "savefig", "tight_layout"})
+    {
+        this->profiler.reset();
+        this->profiler.reset(new Profiler(functions));
+    }
+
+    inline void disable_profiling()
+    {
+        this->profiler.reset();
+    }
 };  // class PLT
 
 std::atomic_int PLT::plt_count{0};
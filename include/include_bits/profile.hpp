@@ -0,0 +1,295 @@
+#ifndef __PLT_PROFILE_HPP__
+#define __PLT_PROFILE_HPP__
+
+#include <fstream>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include "utility.hpp"
+
+namespace matplotlibcpp
+{
+/** A python function as measured by Profiler, times are in seconds. */
+struct ProfileEntry
+{
+    std::string function;  // path:line(name), python's own paths are relative
+    long calls;            // including recursive calls
+    double self_time;      // spent in the function itself
+    double total_time;     // including the functions it called
+};
+
+namespace detail
+{
+/** A function of a cProfile snapshot with the functions it called and their time from this caller. */
+struct ProfileNode
+{
+    ProfileEntry entry;
+    std::vector<std::pair<std::size_t, double>> callees;
+    bool has_caller;
+};
+
+// path:line(name) of a pstats key (filename, lineno, funcname), paths are relative to site-packages
+// or to the standard library, builtins are only named.
+inline std::string get_profile_label(PyObject* key)
+{
+    std::string filename = PyUnicode_AsUTF8(PyTuple_GetItem(key, 0));
+    long line            = PyLong_AsLong(PyTuple_GetItem(key, 1));
+    std::string name     = PyUnicode_AsUTF8(PyTuple_GetItem(key, 2));
+    std::string label;
+    if (filename == "~") {
+        label = name;
+    } else {
+        auto pos = filename.rfind("site-packages/");
+        if (pos != std::string::npos) {
+            filename = filename.substr(pos + std::strlen("site-packages/"));
+        } else if ((pos = filename.rfind("/lib/python")) != std::string::npos) {
+            // the standard library, lib/python3.x/
+            auto end = filename.find('/', pos + std::strlen("/lib/python"));
+            if (end != std::string::npos) {
+                filename = filename.substr(end + 1);
+            }
+        }
+        label = filename + ":" + std::to_string(line) + "(" + name + ")";
+    }
+    // ';' separates the frames of a collapsed stack
+    std::replace(label.begin(), label.end(), ';', ':');
+    return label;
+}
+
+/**
+ * @brief The functions recorded by a cProfile.Profile, which must not be recording.
+ */
+inline std::vector<ProfileNode> get_profile_nodes(PyObject* profile)
+{
+    NewRef created = PyObject_CallMethod(profile, "create_stats", nullptr);
+    NewRef stats = PyObject_GetAttrString(profile, "stats");
+    if (!created || !stats || !PyDict_Check((PyObject*)stats)) {
+        throw std::runtime_error("Couldn't read the profile statistics");
+    }
+
+    std::vector<ProfileNode> nodes;
+    std::unordered_map<std::string, std::size_t> index;
+    PyObject *key, *value;
+    Py_ssize_t pos = 0;
+    while (PyDict_Next(stats, &pos, &key, &value)) {
+        ProfileNode node;
+        node.entry.function = get_profile_label(key);
+        // the call that stops the profiler is recorded as well
+        if (node.entry.function.find("_lsprof.Profiler") != std::string::npos) {
+            continue;
+        }
+        node.entry.calls      = PyLong_AsLong(PyTuple_GetItem(value, 1));
+        node.entry.self_time  = PyFloat_AsDouble(PyTuple_GetItem(value, 2));
+        node.entry.total_time = PyFloat_AsDouble(PyTuple_GetItem(value, 3));
+        node.has_caller       = false;
+        index[node.entry.function] = nodes.size();
+        nodes.push_back(node);
+    }
+
+    // callers of a function map to (cc, nc, tt, ct) of the calls from that caller
+    pos = 0;
+    while (PyDict_Next(stats, &pos, &key, &value)) {
+        auto self = index.find(get_profile_label(key));
+        if (self == index.end()) {
+            continue;
+        }
+        std::size_t k     = self->second;
+        PyObject* callers = PyTuple_GetItem(value, 4);
+        PyObject *caller, *times;
+        Py_ssize_t caller_pos = 0;
+        while (PyDict_Next(callers, &caller_pos, &caller, &times)) {
+            auto it = index.find(get_profile_label(caller));
+            if (it == index.end()) {
+                continue;
+            }
+            nodes[it->second].callees.emplace_back(k, PyFloat_AsDouble(PyTuple_GetItem(times, 3)));
+            nodes[k].has_caller = true;
+        }
+    }
+    return nodes;
+}
+
+// Adds the stacks below nodes[k], which accounts for share of the time of nodes[k], to stacks.
+inline void collapse_stacks(const std::vector<ProfileNode>& nodes,
+                            std::size_t k,
+                            double share,
+                            double min_time,
+                            std::vector<std::size_t>& path,
+                            std::string prefix,
+                            std::map<std::string, double>& stacks)
+{
+    const ProfileNode& node = nodes[k];
+    prefix += (prefix.empty() ? "" : ";") + node.entry.function;
+    stacks[prefix] += share * node.entry.self_time;
+    path.push_back(k);
+    for (const auto& callee : node.callees) {
+        const ProfileNode& child = nodes[callee.first];
+        if (child.entry.total_time <= 0 || std::find(path.begin(), path.end(), callee.first) != path.end()) {
+            continue;
+        }
+        double child_share = share * std::min(callee.second / child.entry.total_time, 1.0);
+        if (child_share * child.entry.total_time >= min_time) {
+            collapse_stacks(nodes, callee.first, child_share, min_time, path, prefix, stacks);
+        }
+    }
+    path.pop_back();
+}
+}  // namespace detail
+
+/** Profiles the python side of selected calls with cProfile.
+ * The interpreter's profiler only runs while a Load_func call of one of the function names is
+ * in progress, e.g. draw, savefig or tight_layout of the pyplot module or of a figure, or between
+ * start and stop. Results accumulate until clear.
+ */
+class Profiler : public detail::CallHook
+{
+public:
+    explicit Profiler(const std::vector<std::string>& functions = {"draw", "savefig", "tight_layout"})
+        : functions(functions.begin(), functions.end()), depth(0)
+    {
+        detail::NewRef cprofile = PyImport_ImportModule("cProfile");
+        if (!cprofile) {
+            throw std::runtime_error("Error loading module cProfile!");
+        }
+        this->profile = PyObject_CallMethod(cprofile, "Profile", nullptr);
+        if (!this->profile) {
+            throw std::runtime_error("Couldn't create a cProfile.Profile");
+        }
+        detail::add_call_hook(this);
+    }
+
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    ~Profiler()
+    {
+        detail::remove_call_hook(this);
+        if (this->depth > 0) {
+            detail::NewRef res = PyObject_CallMethod(this->profile, "disable", nullptr);
+        }
+        Py_XDECREF(this->profile);
+    }
+
+    void on_call(PyObject* fn, PyObject* /*args*/, PyObject* /*kwargs*/) override
+    {
+        if (this->is_profiled(fn)) {
+            this->start();
+        }
+    }
+
+    void on_return(PyObject* fn) override
+    {
+        if (this->is_profiled(fn)) {
+            this->stop();
+        }
+    }
+
+    void start()
+    {
+        if (this->depth++ == 0) {
+            this->call("enable");
+        }
+    }
+
+    void stop()
+    {
+        if (this->depth > 0 && --this->depth == 0) {
+            this->call("disable");
+        }
+    }
+
+    /**
+     * @brief The n functions with the most time of their own, or including their callees if by_total_time.
+     */
+    std::vector<ProfileEntry> get_hotspots(std::size_t n = 20, bool by_total_time = false)
+    {
+        auto nodes = this->get_nodes();
+        std::vector<ProfileEntry> entries;
+        for (const auto& node : nodes) {
+            entries.push_back(node.entry);
+        }
+        auto key = [by_total_time](const ProfileEntry& e) { return by_total_time ? e.total_time : e.self_time; };
+        n        = std::min(n, entries.size());
+        std::partial_sort(entries.begin(), entries.begin() + n, entries.end(),
+                          [&](const ProfileEntry& a, const ProfileEntry& b) { return key(a) > key(b); });
+        entries.resize(n);
+        return entries;
+    }
+
+    /**
+     * @brief Writes the profile as collapsed stacks in microseconds, the input of flamegraph.pl or speedscope.
+     *
+     * cProfile only records caller-callee pairs, so the time of a function is split among its
+     * stacks in proportion to the time its callers spent in it. Stacks of less than min_fraction
+     * of the total time are left out.
+     */
+    void write_collapsed_stacks(const std::string& filename, double min_fraction = 1e-4)
+    {
+        auto nodes   = this->get_nodes();
+        double total = 0;
+        for (const auto& node : nodes) {
+            if (!node.has_caller) {
+                total += node.entry.total_time;
+            }
+        }
+        std::map<std::string, double> stacks;
+        std::vector<std::size_t> path;
+        for (std::size_t k = 0; k < nodes.size(); ++k) {
+            if (!nodes[k].has_caller) {
+                detail::collapse_stacks(nodes, k, 1.0, total * min_fraction, path, "", stacks);
+            }
+        }
+
+        std::ofstream out(filename);
+        for (const auto& stack : stacks) {
+            long us = std::lround(stack.second * 1e6);
+            if (us > 0) {
+                out << stack.first << " " << us << "\n";
+            }
+        }
+        if (!out) {
+            throw std::runtime_error("Couldn't write " + filename);
+        }
+    }
+
+    void clear()
+    {
+        this->call("clear");
+    }
+
+private:
+    // not through Load_func, the profiler's own calls are not reported to the hooks
+    void call(const char* name)
+    {
+        detail::NewRef res = PyObject_CallMethod(this->profile, name, nullptr);
+        if (!res) {
+            throw std::runtime_error(std::string("Profiler: call failed: ") + name);
+        }
+    }
+
+    bool is_profiled(PyObject* fn) const
+    {
+        detail::NewRef name = PyObject_GetAttrString(fn, "__name__");
+        if (!name) {
+            PyErr_Clear();
+            return false;
+        }
+        const char* s = PyUnicode_AsUTF8(name);
+        return s && this->functions.count(s);
+    }
+
+    std::vector<detail::ProfileNode> get_nodes()
+    {
+        if (this->depth > 0) {
+            throw std::runtime_error("Profiler: results are not available while recording");
+        }
+        return detail::get_profile_nodes(this->profile);
+    }
+
+    std::set<std::string> functions;
+    PyObject* profile;
+    int depth;
+};
+}  // namespace matplotlibcpp
+
+#endif  // !__PLT_PROFILE_HPP__
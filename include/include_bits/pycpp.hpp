@@ -14,6 +14,7 @@
 #include <numeric>
 #include <stdexcept>
 #include <string>  // std::stod
+#include <utility>
 #include <vector>
 
 #define NPY_NO_DEPRECATED_API NPY_1_7_API_VERSION
@@ -21,6 +22,73 @@
 
 namespace matplotlibcpp
 {
+/** A column stored in a raw binary file.
+ * The file is memory-mapped read-only and handed to matplotlib as a numpy
+ * view, so pages are only touched when matplotlib reads them.
+ * offset and stride are in bytes; stride = 0 means densely packed elements,
+ * count = -1 means up to the end of the file.
+ */
+struct MemMap
+{
+    explicit MemMap(const std::string& filename,
+                    const std::string& dtype = "float64",
+                    long offset              = 0,
+                    long count               = -1,
+                    long stride              = 0)
+        : filename(filename), dtype(dtype), offset(offset), count(count), stride(stride)
+    {
+    }
+
+    std::string filename;
+    std::string dtype;
+    long offset;
+    long count;
+    long stride;
+};
+
+/** Array data that already lives in python: a numpy array or any object with the buffer protocol,
+ * e.g. a pybind11 py::array or py::buffer of the application that embeds the interpreter.
+ * It is handed to matplotlib without conversion, ndarrays as they are and other buffers as a
+ * numpy view, other objects are refused when used. The handle references the object, copies share it.
+ */
+class ArrayHandle
+{
+public:
+    explicit ArrayHandle(PyObject* object) : object(object)
+    {
+        if (!object) {
+            throw std::runtime_error("ArrayHandle: object is nullptr");
+        }
+        Py_INCREF(this->object);
+    }
+
+    ArrayHandle(const ArrayHandle& other) : object(other.object)
+    {
+        Py_INCREF(this->object);
+    }
+
+    ArrayHandle& operator=(const ArrayHandle& other)
+    {
+        Py_INCREF(other.object);
+        Py_DECREF(this->object);
+        this->object = other.object;
+        return *this;
+    }
+
+    ~ArrayHandle()
+    {
+        Py_DECREF(this->object);
+    }
+
+    PyObject* get() const
+    {
+        return this->object;
+    }
+
+private:
+    PyObject* object;
+};
+
 namespace detail
 {
 /** General wrapper around a PyObject*.
@@ -30,6 +98,13 @@ class DecRefDtor
 {
 public:
     DecRefDtor(PyObject* ref) : m_ref{ref} {}
+    // A copy would release the reference twice.
+    DecRefDtor(const DecRefDtor&) = delete;
+    DecRefDtor& operator=(const DecRefDtor&) = delete;
+    DecRefDtor(DecRefDtor&& other) : m_ref{other.m_ref}
+    {
+        other.m_ref = NULL;
+    }
     Py_ssize_t ref_count() const
     {
         return m_ref ? Py_REFCNT(m_ref) : 0;
@@ -71,6 +146,7 @@ public:
     {
         Py_XINCREF(m_ref);
     }
+    BorrowedRef(BorrowedRef&& other) : DecRefDtor(std::move(other)) {}
 };
 
 /** Wrapper around a PyObject* that is a new reference.
@@ -82,8 +158,72 @@ class NewRef : public DecRefDtor
 {
 public:
     NewRef(PyObject* new_ref) : DecRefDtor(new_ref) {}
+    NewRef(NewRef&& other) : DecRefDtor(std::move(other)) {}
 };
 
+/** numpy type number of a C++ scalar type. */
+template <typename T>
+struct npy_type;
+
+#define MATPLOTLIBCPP_NPY_TYPE(T, N)        \
+    template <>                             \
+    struct npy_type<T>                      \
+    {                                       \
+        static const int value = N;         \
+    }
+
+MATPLOTLIBCPP_NPY_TYPE(bool, NPY_BOOL);
+MATPLOTLIBCPP_NPY_TYPE(signed char, NPY_BYTE);
+MATPLOTLIBCPP_NPY_TYPE(unsigned char, NPY_UBYTE);
+MATPLOTLIBCPP_NPY_TYPE(short, NPY_SHORT);
+MATPLOTLIBCPP_NPY_TYPE(unsigned short, NPY_USHORT);
+MATPLOTLIBCPP_NPY_TYPE(int, NPY_INT);
+MATPLOTLIBCPP_NPY_TYPE(unsigned int, NPY_UINT);
+MATPLOTLIBCPP_NPY_TYPE(long, NPY_LONG);
+MATPLOTLIBCPP_NPY_TYPE(unsigned long, NPY_ULONG);
+MATPLOTLIBCPP_NPY_TYPE(long long, NPY_LONGLONG);
+MATPLOTLIBCPP_NPY_TYPE(unsigned long long, NPY_ULONGLONG);
+MATPLOTLIBCPP_NPY_TYPE(float, NPY_FLOAT);
+MATPLOTLIBCPP_NPY_TYPE(double, NPY_DOUBLE);
+
+#undef MATPLOTLIBCPP_NPY_TYPE
+
+/** A new C-contiguous ndarray owning a copy of data.
+ * Requires the numpy C-API, which is loaded by Modules::init.
+ */
+template <typename T>
+inline NewRef get_pyarray(const T* data, const std::vector<npy_intp>& shape)
+{
+    PyObject* array = PyArray_SimpleNew(int(shape.size()), const_cast<npy_intp*>(shape.data()), npy_type<T>::value);
+    if (!array) {
+        throw std::runtime_error("Couldn't allocate ndarray.");
+    }
+    if (data) {
+        std::copy(data, data + PyArray_SIZE((PyArrayObject*)array), (T*)PyArray_DATA((PyArrayObject*)array));
+    }
+    return array;
+}
+
+template <typename T>
+inline NewRef get_pyarray(const std::vector<T>& v)
+{
+    return get_pyarray(v.data(), {npy_intp(v.size())});
+}
+
+/** A read-only C-contiguous ndarray wrapping data without copying.
+ * data must stay valid as long as the array is in use.
+ */
+template <typename T>
+inline NewRef get_pyarray_view(const T* data, const std::vector<npy_intp>& shape)
+{
+    PyObject* array = PyArray_New(&PyArray_Type, int(shape.size()), const_cast<npy_intp*>(shape.data()),
+                                  npy_type<T>::value, nullptr, const_cast<T*>(data), 0, NPY_ARRAY_CARRAY_RO, nullptr);
+    if (!array) {
+        throw std::runtime_error("Couldn't create ndarray view.");
+    }
+    return array;
+}
+
 template <typename Numeric>
 inline NewRef get_pylist(const std::vector<Numeric>& v)
 {
@@ -103,22 +243,170 @@ inline NewRef get_pylist(const std::vector<std::string>& strings)
     return list;
 }
 
+/** Decodes UTF-8 to code points into out, or only counts them if out is nullptr.
+ * Invalid or truncated sequences become U+FFFD.
+ */
+inline std::size_t decode_utf8(const std::string& s, std::uint32_t* out)
+{
+    std::size_t n = 0;
+    for (std::size_t i = 0; i < s.size(); ++n) {
+        unsigned char c = static_cast<unsigned char>(s[i]);
+        std::uint32_t cp;
+        std::size_t len;
+        if (c < 0x80) {
+            cp  = c;
+            len = 1;
+        } else if ((c >> 5) == 0x6) {
+            cp  = c & 0x1F;
+            len = 2;
+        } else if ((c >> 4) == 0xE) {
+            cp  = c & 0x0F;
+            len = 3;
+        } else if ((c >> 3) == 0x1E) {
+            cp  = c & 0x07;
+            len = 4;
+        } else {
+            cp  = 0xFFFD;
+            len = 0;
+        }
+        for (std::size_t k = 1; k < len; ++k) {
+            if (i + k >= s.size() || (static_cast<unsigned char>(s[i + k]) & 0xC0) != 0x80) {
+                len = 0;
+                break;
+            }
+            cp = (cp << 6) | (static_cast<unsigned char>(s[i + k]) & 0x3F);
+        }
+        if (len == 0) {
+            cp  = 0xFFFD;
+            len = 1;
+        }
+        if (out) {
+            out[n] = cp;
+        }
+        i += len;
+    }
+    return n;
+}
+
+/** A numpy fixed-width unicode array (dtype <U) of the strings.
+ * The strings are decoded straight into the array, no Python string is created per element.
+ */
+inline NewRef get_unicode_array(const std::vector<std::string>& strings)
+{
+    std::size_t width = 1;
+    for (const auto& s : strings) {
+        width = std::max(width, decode_utf8(s, nullptr));
+    }
+    npy_intp dims[1] = {npy_intp(strings.size())};
+    PyObject* array  = PyArray_New(&PyArray_Type, 1, dims, NPY_UNICODE, nullptr, nullptr, int(4 * width), 0, nullptr);
+    if (!array) {
+        throw std::runtime_error("Couldn't allocate unicode ndarray.");
+    }
+    std::uint32_t* data = static_cast<std::uint32_t*>(PyArray_DATA((PyArrayObject*)array));
+    std::fill(data, data + width * strings.size(), 0u);
+    for (std::size_t k = 0; k < strings.size(); ++k) {
+        decode_utf8(strings[k], data + k * width);
+    }
+    return array;
+}
+
 template <typename Numeric>
 NewRef get_listlist(const std::vector<std::vector<Numeric>>& ll)
 {
     PyObject* listlist = PyList_New(ll.size());
     for (std::size_t i = 0; i < ll.size(); ++i) {
         auto tmp = get_pylist(ll[i]);
-        Py_IncRef(tmp);
+        // PyList_SetItem steals a reference, tmp releases its own one
+        Py_INCREF(tmp);
         PyList_SetItem(listlist, i, tmp);
     }
     return listlist;
 }
 
+/**
+ * @brief The ndarray of an ArrayHandle: the object itself if it is one, a view of its buffer if it
+ * has the buffer protocol. Other objects, e.g. lists or scalars, are rejected rather than converted.
+ */
+inline NewRef get_array(const ArrayHandle& handle)
+{
+    PyObject* object = handle.get();
+    if (PyArray_Check(object)) {
+        Py_INCREF(object);
+        return object;
+    }
+    if (!PyObject_CheckBuffer(object)) {
+        throw std::runtime_error(std::string("ArrayHandle: not an array or a buffer: ") + Py_TYPE(object)->tp_name);
+    }
+    NewRef array = PyArray_FromAny(object, nullptr, 0, 0, 0, nullptr);
+    if (!array || PyArray_TYPE((PyArrayObject*)(PyObject*)array) == NPY_OBJECT) {
+        PyErr_Clear();
+        throw std::runtime_error("ArrayHandle: the buffer is not an array of numbers");
+    }
+    return array;
+}
+
+inline NewRef get_memmap(const MemMap& m)
+{
+    NewRef numpy = PyImport_ImportModule("numpy");
+    if (!numpy) {
+        throw std::runtime_error("Error loading module numpy!");
+    }
+
+    NewRef dtype = PyObject_CallMethod(numpy, "dtype", "s", m.dtype.c_str());
+    if (!dtype) {
+        PyErr_Clear();
+        throw std::runtime_error("Unknown dtype: " + m.dtype);
+    }
+    NewRef py_itemsize = PyObject_GetAttrString(dtype, "itemsize");
+    long itemsize      = py_itemsize ? PyLong_AsLong(py_itemsize) : -1;
+    if (itemsize <= 0) {
+        PyErr_Clear();
+        throw std::runtime_error("Invalid itemsize of dtype: " + m.dtype);
+    }
+    long stride = m.stride > 0 ? m.stride : itemsize;
+
+    if (m.count == 0) {
+        return PyObject_CallMethod(numpy, "empty", "lO", 0L, (PyObject*)dtype);
+    }
+
+    // Map the raw bytes only, numpy.memmap takes care of aligning the offset to the page size.
+    NewRef memmap = PyObject_GetAttrString(numpy, "memmap");
+    NewRef args   = Py_BuildValue("(s)", m.filename.c_str());
+    NewRef kwargs = Py_BuildValue("{s:s,s:s,s:l}", "dtype", "uint8", "mode", "r", "offset", m.offset);
+    if (m.count > 0) {
+        NewRef shape = PyLong_FromLong((m.count - 1) * stride + itemsize);
+        PyDict_SetItemString(kwargs, "shape", shape);
+    }
+    NewRef raw = PyObject_Call(memmap, args, kwargs);
+    if (!raw) {
+        throw std::runtime_error("Couldn't map file: " + m.filename);
+    }
+
+    long nbytes = PyObject_Size(raw);
+    long count  = m.count > 0 ? m.count : (nbytes < itemsize ? 0 : (nbytes - itemsize) / stride + 1);
+
+    // A strided view on top of the mapping, nothing is read from the file here.
+    NewRef ndarray   = PyObject_GetAttrString(numpy, "ndarray");
+    NewRef view_args = PyTuple_New(0);
+    NewRef view_kwargs =
+        Py_BuildValue("{s:(l),s:O,s:O,s:(l)}", "shape", count, "dtype", (PyObject*)dtype, "buffer", (PyObject*)raw,
+                      "strides", stride);
+    NewRef view = PyObject_Call(ndarray, view_args, view_kwargs);
+    if (!view) {
+        throw std::runtime_error("Couldn't create a view on file: " + m.filename);
+    }
+    return view;
+}
+
+/** Arguments of a call, converted to Python objects.
+ * The container owns one reference to each element and releases them on destruction.
+ */
 class PyContainer
 {
 public:
     PyContainer() = default;
+    PyContainer(const PyContainer&) = delete;
+    PyContainer& operator=(const PyContainer&) = delete;
     ~PyContainer()
     {
         for (std::size_t i = 0; i < this->memory.size(); ++i) {
@@ -166,7 +454,9 @@ public:
 
     PyContainer& operator<<(const bool& x)
     {
-        this->memory.push_back(x ? Py_True : Py_False);
+        PyObject* value = x ? Py_True : Py_False;
+        Py_INCREF(value);
+        this->memory.push_back(value);
         return *this;
     }
 
@@ -176,28 +466,41 @@ public:
         return *this;
     }
 
+    // Steals the new reference x.
     PyContainer& operator<<(PyObject* x)
     {
         this->memory.push_back(x);
         return *this;
     }
 
+    // Unlike a raw PyObject*, which is stolen, the container takes its own reference here.
+    PyContainer& operator<<(const DecRefDtor& x)
+    {
+        Py_XINCREF(x);
+        this->memory.push_back(x);
+        return *this;
+    }
+
     template <typename T = double>
     PyContainer& operator<<(const std::vector<T>& x)
     {
-        auto tmp = detail::get_pylist(x);
-        Py_INCREF(tmp);
-        this->memory.push_back(tmp);
-        return *this;
+        return *this << detail::get_pylist(x);
     }
 
     template <typename T = double>
     PyContainer& operator<<(const std::vector<std::vector<T>>& x)
     {
-        auto tmp = detail::get_listlist(x);
-        Py_INCREF(tmp);
-        this->memory.push_back(tmp);
-        return *this;
+        return *this << detail::get_listlist(x);
+    }
+
+    PyContainer& operator<<(const MemMap& x)
+    {
+        return *this << detail::get_memmap(x);
+    }
+
+    PyContainer& operator<<(const ArrayHandle& x)
+    {
+        return *this << detail::get_array(x);
     }
 
     void print()
@@ -0,0 +1,119 @@
+#ifndef __PLT_QUIVER_HPP__
+#define __PLT_QUIVER_HPP__
+
+#include <cmath>
+#include "utility.hpp"
+
+namespace matplotlibcpp
+{
+/** Options of quiver on a structured grid.
+ * The grid is cut into square blocks of cells so that at most arrows arrows are drawn
+ * along its longer side, every block becomes one arrow.
+ */
+struct QuiverOptions
+{
+    explicit QuiverOptions(long arrows = 32, bool average = true, bool colored = false, unsigned nthreads = 0)
+        : arrows(arrows), average(average), colored(colored), nthreads(nthreads)
+    {
+    }
+
+    long arrows;        // arrows along the longer side of the grid
+    bool average;       // block average, otherwise the center sample of every block
+    bool colored;       // color the arrows by their magnitude
+    unsigned nthreads;  // 0: std::thread::hardware_concurrency()
+};
+
+namespace detail
+{
+/** Decimated vector field, U, V and C are row-major Y.size() x X.size(). */
+struct QuiverField
+{
+    std::vector<double> X, Y, U, V, C;
+};
+
+// Mean coordinate of the block [begin, end), or its center sample.
+template <typename Scalar>
+double get_block_position(const std::vector<Scalar>& coords, long begin, long end, bool average)
+{
+    if (!average) {
+        return double(coords[(begin + end - 1) / 2]);
+    }
+    double sum = 0;
+    for (long k = begin; k < end; ++k) {
+        sum += double(coords[k]);
+    }
+    return sum / (end - begin);
+}
+
+/**
+ * @brief Decimates the field u, v, row-major with y.size() rows and x.size() columns.
+ *
+ * The average of a block points along the mean vector and has the mean magnitude
+ * of the block, so that opposing vectors don't cancel out into a short arrow.
+ * Non-finite vectors are ignored, a block without any gives a NaN arrow, which is not drawn.
+ */
+template <typename ScalarX, typename ScalarY, typename ScalarU, typename ScalarV>
+QuiverField get_quiver_field(const std::vector<ScalarX>& x,
+                             const std::vector<ScalarY>& y,
+                             const ScalarU* u,
+                             const ScalarV* v,
+                             const QuiverOptions& options)
+{
+    long rows = long(y.size()), cols = long(x.size());
+    long step = std::max(1L, (std::max(rows, cols) + options.arrows - 1) / std::max(options.arrows, 1L));
+    long nx = (cols + step - 1) / step, ny = (rows + step - 1) / step;
+
+    QuiverField field;
+    field.X.resize(nx);
+    field.Y.resize(ny);
+    field.U.resize(nx * ny);
+    field.V.resize(nx * ny);
+    field.C.resize(nx * ny);
+    for (long bx = 0; bx < nx; ++bx) {
+        field.X[bx] = get_block_position(x, bx * step, std::min(cols, (bx + 1) * step), options.average);
+    }
+    for (long by = 0; by < ny; ++by) {
+        field.Y[by] = get_block_position(y, by * step, std::min(rows, (by + 1) * step), options.average);
+    }
+
+    // one task per row of blocks
+    parallel_for(std::size_t(ny), options.nthreads, [&](std::size_t by) {
+        long bi0 = long(by) * step, bi1 = std::min(rows, bi0 + step);
+        for (long bx = 0; bx < nx; ++bx) {
+            long bj0 = bx * step, bj1 = std::min(cols, bj0 + step);
+            // the center sample only when not averaging
+            long i0 = options.average ? bi0 : (bi0 + bi1 - 1) / 2, i1 = options.average ? bi1 : i0 + 1;
+            long j0 = options.average ? bj0 : (bj0 + bj1 - 1) / 2, j1 = options.average ? bj1 : j0 + 1;
+
+            double su = 0, sv = 0, smag = 0;
+            long n = 0;
+            for (long i = i0; i < i1; ++i) {
+                for (long j = j0; j < j1; ++j) {
+                    double ui = double(u[i * cols + j]), vi = double(v[i * cols + j]);
+                    if (std::isfinite(ui) && std::isfinite(vi)) {
+                        su += ui;
+                        sv += vi;
+                        smag += std::hypot(ui, vi);
+                        ++n;
+                    }
+                }
+            }
+
+            long k = long(by) * nx + bx;
+            if (n == 0) {
+                field.U[k] = field.V[k] = field.C[k] = NAN;
+                continue;
+            }
+            double norm = std::hypot(su, sv);
+            double mag  = smag / n;
+            field.U[k]  = norm > 0 ? su / norm * mag : 0.0;
+            field.V[k]  = norm > 0 ? sv / norm * mag : 0.0;
+            field.C[k]  = mag;
+        }
+    });
+    return field;
+}
+}  // namespace detail
+}  // namespace matplotlibcpp
+
+#endif  // !__PLT_QUIVER_HPP__
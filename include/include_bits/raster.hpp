@@ -0,0 +1,227 @@
+#ifndef __PLT_RASTER_HPP__
+#define __PLT_RASTER_HPP__
+
+#include <cmath>
+#include <limits>
+#include <thread>
+#include "utility.hpp"
+
+namespace matplotlibcpp
+{
+/** Options of the native rasterizer.
+ * Passing RasterOptions to scatter/plot accumulates the points or polylines into
+ * a density image at the pixel resolution of the axes, which is then drawn
+ * by matplotlib as a single imshow layer.
+ */
+struct RasterOptions
+{
+    explicit RasterOptions(double alpha      = 1.0,
+                           bool antialiased  = true,
+                           bool log          = false,
+                           unsigned nthreads = 0,
+                           double dpi        = 0)
+        : alpha(alpha), antialiased(antialiased), log(log), nthreads(nthreads), dpi(dpi)
+    {
+    }
+
+    double alpha;       // alpha of the image layer
+    bool antialiased;   // bilinear splatting instead of nearest pixel
+    bool log;           // logarithmic color scale of the density
+    unsigned nthreads;  // 0: std::thread::hardware_concurrency()
+    double dpi;         // 0: dpi of the figure
+};
+
+namespace detail
+{
+/** Accumulates points and polylines into a float density buffer.
+ * Every thread accumulates its share of the input into a private buffer,
+ * the buffers are then summed up in parallel row bands.
+ */
+class Rasterizer
+{
+public:
+    Rasterizer(long width, long height, double xmin, double xmax, double ymin, double ymax, unsigned nthreads = 0)
+        : width(std::max(width, 1L)),
+          height(std::max(height, 1L)),
+          xmin(xmin),
+          ymin(ymin),
+          sx(std::max(width, 1L) / (xmax - xmin)),
+          sy(std::max(height, 1L) / (ymax - ymin)),
+          nthreads(nthreads ? nthreads : std::max(std::thread::hardware_concurrency(), 1u))
+    {
+    }
+
+    template <typename ScalarX, typename ScalarY>
+    void points(const ScalarX* x, const ScalarY* y, std::size_t n, bool antialiased, float* out)
+    {
+        this->run(n, out, [&](std::size_t begin, std::size_t end, float* buf) {
+            for (std::size_t i = begin; i < end; ++i) {
+                this->splat(this->px(x[i]), this->py(y[i]), 1.0f, antialiased, buf);
+            }
+        });
+    }
+
+    template <typename ScalarX, typename ScalarY>
+    void polyline(const ScalarX* x, const ScalarY* y, std::size_t n, bool antialiased, float* out)
+    {
+        if (n < 2) {
+            return;
+        }
+        // n - 1 segments, segment i goes from point i to point i + 1
+        this->run(n - 1, out, [&](std::size_t begin, std::size_t end, float* buf) {
+            for (std::size_t i = begin; i < end; ++i) {
+                this->segment(this->px(x[i]), this->py(y[i]), this->px(x[i + 1]), this->py(y[i + 1]), antialiased,
+                              buf);
+            }
+        });
+    }
+
+    long get_width() const
+    {
+        return this->width;
+    }
+
+    long get_height() const
+    {
+        return this->height;
+    }
+
+private:
+    template <typename Kernel>
+    void run(std::size_t n, float* out, Kernel kernel)
+    {
+        const std::size_t npixels = std::size_t(this->width) * std::size_t(this->height);
+        unsigned nthreads         = unsigned(std::min<std::size_t>(this->nthreads, n / 4096 + 1));
+        if (nthreads <= 1) {
+            kernel(0, n, out);
+            return;
+        }
+
+        // The first thread writes directly into out, the others into private buffers.
+        std::vector<std::vector<float>> buffers(nthreads - 1, std::vector<float>(npixels, 0.0f));
+        std::vector<std::thread> threads;
+        for (unsigned t = 0; t < nthreads; ++t) {
+            std::size_t begin = n * t / nthreads;
+            std::size_t end   = n * (t + 1) / nthreads;
+            float* buf        = t == 0 ? out : buffers[t - 1].data();
+            threads.emplace_back([=, &kernel]() { kernel(begin, end, buf); });
+        }
+        for (auto& th : threads) {
+            th.join();
+        }
+
+        threads.clear();
+        for (unsigned t = 0; t < nthreads; ++t) {
+            std::size_t begin = npixels * t / nthreads;
+            std::size_t end   = npixels * (t + 1) / nthreads;
+            threads.emplace_back([=, &buffers]() {
+                for (const auto& buf : buffers) {
+                    for (std::size_t i = begin; i < end; ++i) {
+                        out[i] += buf[i];
+                    }
+                }
+            });
+        }
+        for (auto& th : threads) {
+            th.join();
+        }
+    }
+
+    template <typename Scalar>
+    double px(Scalar x) const
+    {
+        return (double(x) - this->xmin) * this->sx;
+    }
+
+    template <typename Scalar>
+    double py(Scalar y) const
+    {
+        return (double(y) - this->ymin) * this->sy;
+    }
+
+    void splat(double px, double py, float weight, bool antialiased, float* buf) const
+    {
+        if (!std::isfinite(px) || !std::isfinite(py)) {
+            return;
+        }
+        if (!antialiased) {
+            long i = std::min(long(std::floor(px)), this->width - 1);
+            long j = std::min(long(std::floor(py)), this->height - 1);
+            if (i >= 0 && j >= 0) {
+                buf[j * this->width + i] += weight;
+            }
+            return;
+        }
+        // bilinear weights with respect to the four closest pixel centers
+        double fx = px - 0.5, fy = py - 0.5;
+        long i0 = long(std::floor(fx)), j0 = long(std::floor(fy));
+        float wx = float(fx - i0), wy = float(fy - j0);
+        this->add(i0, j0, weight * (1 - wx) * (1 - wy), buf);
+        this->add(i0 + 1, j0, weight * wx * (1 - wy), buf);
+        this->add(i0, j0 + 1, weight * (1 - wx) * wy, buf);
+        this->add(i0 + 1, j0 + 1, weight * wx * wy, buf);
+    }
+
+    void add(long i, long j, float weight, float* buf) const
+    {
+        if (i >= 0 && j >= 0 && i < this->width && j < this->height) {
+            buf[j * this->width + i] += weight;
+        }
+    }
+
+    // Samples the segment at sub-pixel steps, every sample carries its share of the length in pixels.
+    void segment(double x0, double y0, double x1, double y1, bool antialiased, float* buf) const
+    {
+        if (!std::isfinite(x0) || !std::isfinite(y0) || !std::isfinite(x1) || !std::isfinite(y1)) {
+            return;
+        }
+        double length = std::hypot(x1 - x0, y1 - y0);
+        long steps    = std::max(1L, long(std::ceil(length)));
+        float weight  = float(std::max(length, 1.0) / steps);
+        for (long k = 0; k < steps; ++k) {
+            double t = (k + 0.5) / steps;
+            this->splat(x0 + t * (x1 - x0), y0 + t * (y1 - y0), weight, antialiased, buf);
+        }
+    }
+
+    long width;
+    long height;
+    double xmin;
+    double ymin;
+    double sx;
+    double sy;
+    unsigned nthreads;
+};
+
+/** Data limits of x and y, ignoring non-finite values.
+ * Degenerate ranges are widened so the result can always be used as an extent.
+ */
+template <typename ScalarX, typename ScalarY>
+std::array<double, 4> get_extent(const ScalarX* x, const ScalarY* y, std::size_t n)
+{
+    double inf = std::numeric_limits<double>::infinity();
+    std::array<double, 4> extent{{inf, -inf, inf, -inf}};
+    for (std::size_t i = 0; i < n; ++i) {
+        double xi = double(x[i]), yi = double(y[i]);
+        if (std::isfinite(xi) && std::isfinite(yi)) {
+            extent[0] = std::min(extent[0], xi);
+            extent[1] = std::max(extent[1], xi);
+            extent[2] = std::min(extent[2], yi);
+            extent[3] = std::max(extent[3], yi);
+        }
+    }
+    if (extent[0] > extent[1]) {
+        extent = {{0.0, 1.0, 0.0, 1.0}};
+    }
+    for (int k = 0; k < 4; k += 2) {
+        if (extent[k] == extent[k + 1]) {
+            extent[k] -= 0.5;
+            extent[k + 1] += 0.5;
+        }
+    }
+    return extent;
+}
+}  // namespace detail
+}  // namespace matplotlibcpp
+
+#endif  // !__PLT_RASTER_HPP__
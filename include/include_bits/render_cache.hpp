@@ -0,0 +1,408 @@
+#ifndef __PLT_RENDER_CACHE_HPP__
+#define __PLT_RENDER_CACHE_HPP__
+
+#include "utility.hpp"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+
+namespace matplotlibcpp
+{
+namespace detail
+{
+const std::uint64_t hash_prime1 = 0x9E3779B185EBCA87ULL;
+const std::uint64_t hash_prime2 = 0xC2B2AE3D27D4EB4FULL;
+
+inline std::uint64_t rotl(std::uint64_t x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+// Final avalanche of MurmurHash3.
+inline std::uint64_t mix(std::uint64_t h)
+{
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+inline std::uint64_t hash_round(std::uint64_t acc, std::uint64_t word)
+{
+    return rotl(acc + word * hash_prime2, 31) * hash_prime1;
+}
+
+/**
+ * @brief 64-bit non-cryptographic hash of a buffer, four independent lanes of 8-byte words like XXH64.
+ */
+inline std::uint64_t get_hash(const void* data, std::size_t size, std::uint64_t seed = 0)
+{
+    const unsigned char* p   = static_cast<const unsigned char*>(data);
+    const unsigned char* end = p + size;
+    std::uint64_t v[4]       = {seed + hash_prime1 + hash_prime2, seed + hash_prime2, seed, seed - hash_prime1};
+    std::uint64_t word;
+    for (; p + 32 <= end; p += 32) {
+        for (int i = 0; i < 4; ++i) {
+            std::memcpy(&word, p + 8 * i, 8);
+            v[i] = hash_round(v[i], word);
+        }
+    }
+    std::uint64_t h = rotl(v[0], 1) + rotl(v[1], 7) + rotl(v[2], 12) + rotl(v[3], 18) + size;
+    for (; p + 8 <= end; p += 8) {
+        std::memcpy(&word, p, 8);
+        h = rotl(h ^ hash_round(0, word), 27) * hash_prime1;
+    }
+    for (; p < end; ++p) {
+        h = rotl(h ^ (*p * hash_prime2), 11) * hash_prime1;
+    }
+    return mix(h);
+}
+
+/**
+ * @brief get_hash of a large buffer, computed in parallel on chunks.
+ *
+ * The chunk size is fixed so the hash does not depend on the number of threads.
+ */
+inline std::uint64_t get_hash(const void* data, std::size_t size, std::uint64_t seed, unsigned nthreads)
+{
+    const std::size_t chunk = std::size_t(1) << 20;
+    if (size <= 4 * chunk) {
+        return get_hash(data, size, seed);
+    }
+    const char* p = static_cast<const char*>(data);
+    std::vector<std::uint64_t> hashes((size + chunk - 1) / chunk);
+    parallel_for(hashes.size(), nthreads, [&](std::size_t k) {
+        hashes[k] = get_hash(p + k * chunk, std::min(chunk, size - k * chunk), seed + k);
+    });
+    return get_hash(hashes.data(), hashes.size() * sizeof(std::uint64_t), seed ^ size);
+}
+
+/** Running hash of the calls made through Load_func.
+ * Arrays are hashed by their raw bytes, other python objects by their type and the order
+ * in which they first appeared, so the same program gets the same hash in every run.
+ * The objects are referenced until reset so their addresses are not reused. Arrays are
+ * only weakly referenced and those still alive are hashed again by get_key, a zero-copy
+ * array changed in place after the call, e.g. a frame behind Image::set_data or an
+ * ArrayHandle, changes the key.
+ */
+class CallRecorder : public CallHook
+{
+public:
+    CallRecorder(std::uint64_t seed, unsigned nthreads) : seed(seed), state(seed), nthreads(nthreads)
+    {
+        add_call_hook(this);
+    }
+
+    CallRecorder(const CallRecorder&) = delete;
+    CallRecorder& operator=(const CallRecorder&) = delete;
+
+    ~CallRecorder()
+    {
+        remove_call_hook(this);
+        this->reset();
+    }
+
+    void on_call(PyObject* fn, PyObject* args, PyObject* kwargs) override
+    {
+        NewRef name = PyObject_GetAttrString(fn, "__qualname__");
+        if (!name) {
+            PyErr_Clear();
+        }
+        const char* qualname = name ? PyUnicode_AsUTF8(name) : "";
+        // saving doesn't change the figure, and its filename must not matter
+        if (std::strstr(qualname, "savefig")) {
+            return;
+        }
+        std::uint64_t h = get_hash(qualname, std::strlen(qualname), 1);
+        // the object of a method, e.g. which axes
+        if (PyMethod_Check(fn)) {
+            h = this->combine(h, PyMethod_GET_SELF(fn));
+        }
+        h           = this->combine(h, args);
+        h           = this->combine(h, kwargs);
+        this->state = mix(this->state ^ h) + hash_prime1;
+    }
+
+    /**
+     * @brief Hash of the calls so far, of the current data of the arrays and of extra, e.g. the output format.
+     */
+    std::uint64_t get_key(const std::string& extra)
+    {
+        std::uint64_t h = this->state;
+        for (auto ref : this->arrays) {
+            PyObject* array = PyWeakref_GetObject(ref);
+            h = mix_in(h, array != Py_None ? this->get_array_hash((PyArrayObject*)array) : std::uint64_t(0));
+        }
+        return get_hash(extra.data(), extra.size(), h);
+    }
+
+    std::uint64_t get_key(const std::string& extra, PyObject* object)
+    {
+        return this->combine(this->get_key(extra), object);
+    }
+
+    void reset()
+    {
+        for (auto& item : this->objects) {
+            Py_DECREF(item.first);
+        }
+        this->objects.clear();
+        for (auto ref : this->arrays) {
+            Py_DECREF(ref);
+        }
+        this->arrays.clear();
+        this->array_index.clear();
+        this->state = this->seed;
+    }
+
+private:
+    static std::uint64_t mix_in(std::uint64_t h, std::uint64_t value)
+    {
+        return mix(h + hash_prime2) ^ value;
+    }
+
+    std::uint64_t combine(std::uint64_t h, PyObject* value)
+    {
+        if (value == nullptr || value == Py_None) {
+            return mix_in(h, std::uint64_t(0));
+        }
+        if (PyBool_Check(value)) {
+            return mix_in(h, std::uint64_t(value == Py_True ? 1 : 2));
+        }
+        if (PyLong_Check(value)) {
+            int overflow      = 0;
+            long long integer = PyLong_AsLongLongAndOverflow(value, &overflow);
+            if (!overflow) {
+                return mix_in(mix_in(h, 3), std::uint64_t(integer));
+            }
+            NewRef str = PyObject_Str(value);
+            return this->combine(h, str);
+        }
+        if (PyFloat_Check(value)) {
+            double number = PyFloat_AsDouble(value);
+            return mix_in(h, get_hash(&number, sizeof(number), 4));
+        }
+        if (PyUnicode_Check(value)) {
+            Py_ssize_t size;
+            const char* s = PyUnicode_AsUTF8AndSize(value, &size);
+            return mix_in(h, get_hash(s, std::size_t(size), 5));
+        }
+        if (PyTuple_Check(value) || PyList_Check(value)) {
+            h = mix_in(h, std::uint64_t(6) + std::uint64_t(PySequence_Size(value)));
+            for (Py_ssize_t i = 0; i < PySequence_Size(value); ++i) {
+                h = this->combine(h, PySequence_Fast_GET_ITEM(value, i));
+            }
+            return h;
+        }
+        if (PyDict_Check(value)) {
+            h              = mix_in(h, std::uint64_t(7) + std::uint64_t(PyDict_Size(value)));
+            Py_ssize_t pos = 0;
+            PyObject *key, *item;
+            while (PyDict_Next(value, &pos, &key, &item)) {
+                h = this->combine(this->combine(h, key), item);
+            }
+            return h;
+        }
+        if (PyArray_Check(value)) {
+            this->track_array(value);
+            return mix_in(h, this->get_array_hash((PyArrayObject*)value));
+        }
+        // any other object: its type and when it first appeared
+        auto it = this->objects.find(value);
+        if (it == this->objects.end()) {
+            Py_INCREF(value);
+            it = this->objects.emplace(value, this->objects.size()).first;
+        }
+        const char* type = Py_TYPE(value)->tp_name;
+        return mix_in(mix_in(h, get_hash(type, std::strlen(type), 8)), std::uint64_t(it->second));
+    }
+
+    // Keeps a weak reference to the array, once, in the order of first appearance.
+    void track_array(PyObject* array)
+    {
+        auto it = this->array_index.find(array);
+        if (it != this->array_index.end() && PyWeakref_GetObject(this->arrays[it->second]) == array) {
+            return;
+        }
+        PyObject* ref = PyWeakref_NewRef(array, nullptr);
+        if (!ref) {
+            PyErr_Clear();
+            return;
+        }
+        this->array_index[array] = this->arrays.size();
+        this->arrays.push_back(ref);
+    }
+
+    std::uint64_t get_array_hash(PyArrayObject* array)
+    {
+        NewRef contiguous = (PyObject*)PyArray_GETCONTIGUOUS(array);
+        auto a            = (PyArrayObject*)(PyObject*)contiguous;
+        std::uint64_t h   = get_hash(PyArray_SHAPE(a), sizeof(npy_intp) * PyArray_NDIM(a), PyArray_TYPE(a));
+        return get_hash(PyArray_DATA(a), std::size_t(PyArray_NBYTES(a)), h, this->nthreads);
+    }
+
+    std::uint64_t seed;
+    std::uint64_t state;
+    unsigned nthreads;
+    std::unordered_map<PyObject*, std::size_t> objects;
+    std::vector<PyObject*> arrays;  // weak references
+    std::unordered_map<PyObject*, std::size_t> array_index;
+};
+
+/** mkdir -p */
+inline void make_directories(const std::string& directory)
+{
+    for (std::size_t pos = directory.find('/', 1);; pos = directory.find('/', pos + 1)) {
+        std::string path = directory.substr(0, pos);
+        if (::mkdir(path.c_str(), 0755) != 0 && errno != EEXIST) {
+            throw std::runtime_error("Couldn't create the directory: " + path);
+        }
+        if (pos == std::string::npos) {
+            break;
+        }
+    }
+}
+
+// The format argument of savefig, else the extension of filename.
+inline std::string get_format(const std::string& filename, const std::string& format)
+{
+    if (!format.empty()) {
+        return format;
+    }
+    std::size_t dot = filename.rfind('.'), slash = filename.rfind('/');
+    return dot == std::string::npos || (slash != std::string::npos && dot < slash) ? "" : filename.substr(dot + 1);
+}
+
+// Copies a file through a temporary in the destination directory, so readers never see a partial file.
+inline bool copy_file(const std::string& from, const std::string& to)
+{
+    std::string tmp = to + ".tmp" + std::to_string(::getpid());
+    {
+        std::ifstream in(from, std::ios::binary);
+        std::ofstream out(tmp, std::ios::binary);
+        if (!in || !out) {
+            return false;
+        }
+        out << in.rdbuf();
+        if (!out) {
+            std::remove(tmp.c_str());
+            return false;
+        }
+    }
+    if (std::rename(tmp.c_str(), to.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+}  // namespace detail
+
+/** Content-addressed cache of rendered figures.
+ * The key hashes every call that built the figure with its arguments and data, the current
+ * data of the arrays still alive, plus the matplotlib version, the dpi and the format. On a hit savefig copies the cached file and
+ * skips the rendering. Files are evicted least recently used first once the directory
+ * exceeds max_bytes.
+ */
+class RenderCache
+{
+public:
+    RenderCache(const std::string& directory, std::size_t max_bytes, unsigned nthreads, const std::string& version)
+        : directory(directory),
+          max_bytes(max_bytes),
+          recorder(detail::get_hash(version.data(), version.size()), nthreads)
+    {
+        detail::make_directories(directory);
+    }
+
+    /**
+     * @brief Path of the cached file of the current figure, for the given dpi and format.
+     */
+    std::string get_path(long dpi, const std::string& format, PyObject* fig = nullptr)
+    {
+        std::string extra = std::to_string(dpi) + "." + format;
+        std::uint64_t key = fig ? this->recorder.get_key(extra, fig) : this->recorder.get_key(extra);
+        char name[17];
+        std::snprintf(name, sizeof(name), "%016llx", (unsigned long long)key);
+        return this->directory + "/" + name + (format.empty() ? "" : "." + format);
+    }
+
+    /**
+     * @brief Copies the cached file to filename, returns false on a miss.
+     */
+    bool fetch(const std::string& path, const std::string& filename)
+    {
+        if (::access(path.c_str(), R_OK) != 0 || !detail::copy_file(path, filename)) {
+            return false;
+        }
+        // mark as recently used
+        ::utimensat(AT_FDCWD, path.c_str(), nullptr, 0);
+        return true;
+    }
+
+    void store(const std::string& path, const std::string& filename)
+    {
+        if (detail::copy_file(filename, path)) {
+            this->evict();
+        }
+    }
+
+    // Forgets the recorded calls, once no figure is being built.
+    void reset()
+    {
+        this->recorder.reset();
+    }
+
+private:
+    void evict()
+    {
+        struct File
+        {
+            struct timespec mtime;
+            std::size_t size;
+            std::string path;
+        };
+        std::vector<File> files;
+        std::size_t total = 0;
+        DIR* dir          = ::opendir(this->directory.c_str());
+        if (!dir) {
+            return;
+        }
+        while (struct dirent* entry = ::readdir(dir)) {
+            std::string path = this->directory + "/" + entry->d_name;
+            struct stat st;
+            if (entry->d_name[0] == '.' || ::stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode) ||
+                std::strstr(entry->d_name, ".tmp") != nullptr) {
+                continue;
+            }
+            files.push_back({st.st_mtim, std::size_t(st.st_size), path});
+            total += std::size_t(st.st_size);
+        }
+        ::closedir(dir);
+        if (total <= this->max_bytes) {
+            return;
+        }
+        std::sort(files.begin(), files.end(), [](const File& a, const File& b) {
+            return a.mtime.tv_sec != b.mtime.tv_sec ? a.mtime.tv_sec < b.mtime.tv_sec : a.mtime.tv_nsec < b.mtime.tv_nsec;
+        });
+        for (std::size_t k = 0; k < files.size() && total > this->max_bytes; ++k) {
+            if (std::remove(files[k].path.c_str()) == 0) {
+                total -= files[k].size;
+            }
+        }
+    }
+
+    std::string directory;
+    std::size_t max_bytes;
+    detail::CallRecorder recorder;
+};
+}  // namespace matplotlibcpp
+
+#endif  // !__PLT_RENDER_CACHE_HPP__
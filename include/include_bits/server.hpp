@@ -0,0 +1,444 @@
+#ifndef __PLT_SERVER_HPP__
+#define __PLT_SERVER_HPP__
+
+#include "utility.hpp"
+
+#include <atomic>
+#include <unordered_map>
+#include "ipc.hpp"
+
+namespace matplotlibcpp
+{
+namespace detail
+{
+/** Mapping of an array received through a memfd, released with the array. */
+struct SharedBuffer
+{
+    void* data;
+    std::size_t size;
+
+    static void release(PyObject* capsule)
+    {
+        auto buffer = static_cast<SharedBuffer*>(PyCapsule_GetPointer(capsule, "matplotlibcpp.SharedBuffer"));
+        ::munmap(buffer->data, buffer->size);
+        delete buffer;
+    }
+};
+
+inline int get_npy_type(char dtype)
+{
+    switch (dtype) {
+        case 'd':
+            return NPY_DOUBLE;
+        case 'f':
+            return NPY_FLOAT;
+        case 'q':
+            return NPY_INT64;
+        case 'i':
+            return NPY_INT32;
+        case 'B':
+            return NPY_UINT8;
+    }
+    throw std::runtime_error(std::string("unknown dtype: ") + dtype);
+}
+
+// Bytes of an array of the dtype and shape, throws for a negative or overflowing size.
+inline std::size_t get_array_bytes(char dtype, const std::vector<npy_intp>& shape)
+{
+    std::size_t bytes = dtype == 'd' || dtype == 'q' ? 8 : dtype == 'f' || dtype == 'i' ? 4 : 1;
+    for (auto n : shape) {
+        if (n < 0) {
+            throw std::runtime_error("negative array dimension");
+        }
+        if (n != 0 && bytes > std::size_t(NPY_MAX_INTP) / std::size_t(n)) {
+            throw std::runtime_error("array size overflow");
+        }
+        bytes *= std::size_t(n);
+    }
+    return bytes;
+}
+
+// Message of the pending python exception, which is cleared.
+inline std::string get_python_error()
+{
+    PyObject *type, *value, *traceback;
+    PyErr_Fetch(&type, &value, &traceback);
+    std::string message = "python error";
+    if (value) {
+        NewRef str = PyObject_Str(value);
+        if (str) {
+            message = PyUnicode_AsUTF8(str);
+        }
+    }
+    Py_XDECREF(type);
+    Py_XDECREF(value);
+    Py_XDECREF(traceback);
+    PyErr_Clear();
+    return message;
+}
+}  // namespace detail
+
+/** Plot server sharing one warm interpreter with many short-lived client processes.
+ * It listens on a Unix domain socket and runs the calls of matplotlibcpp::PlotClient,
+ * one client at a time, since pyplot's current figure and rcParams are global. A client
+ * that sends nothing for the idle timeout is disconnected so the next ones are served.
+ * Large arrays arrive as memfds, which are mapped into read-only ndarrays without copying.
+ * The figures, the handles and the rcParams changes of a client are dropped when it disconnects.
+ *
+ * Request: target handle (0 for pyplot), method, keep flag and the arguments as (keyword, value)
+ * pairs, the keyword is empty for positional arguments.
+ * Reply: ok flag, error message, result value (a handle when kept).
+ */
+class PlotServer
+{
+public:
+    explicit PlotServer(const std::string& path   = detail::get_socket_path(),
+                        const std::string& backend = "Agg",
+                        bool need_init_python      = true)
+        : path(path), stopped(false), next_handle(1), idle_timeout(30.0)
+    {
+        this->modules.init(backend, need_init_python);
+        // the rcParams every client starts from, without the backend which stays as it is
+        detail::NewRef rc_params = PyObject_GetAttrString(this->modules.matplotlib, "rcParams");
+        this->rc_params          = PyDict_New();
+        if (!rc_params || PyDict_Merge(this->rc_params, rc_params, 1) != 0) {
+            Py_DECREF(this->rc_params);
+            throw std::runtime_error("Couldn't read the rcParams");
+        }
+        PyDict_DelItemString(this->rc_params, "backend");
+        PyErr_Clear();
+
+        this->listen_fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (this->listen_fd < 0) {
+            throw std::runtime_error(std::string("socket: ") + std::strerror(errno));
+        }
+        sockaddr_un address = detail::get_socket_address(path);
+        ::unlink(path.c_str());
+        // only the owner may connect
+        mode_t mask = ::umask(0077);
+        int res     = ::bind(this->listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+        ::umask(mask);
+        if (res < 0 || ::listen(this->listen_fd, 64) < 0) {
+            std::string error = std::strerror(errno);
+            ::close(this->listen_fd);
+            throw std::runtime_error("Couldn't listen on " + path + ": " + error);
+        }
+    }
+
+    PlotServer(const PlotServer&) = delete;
+    PlotServer& operator=(const PlotServer&) = delete;
+
+    ~PlotServer()
+    {
+        ::close(this->listen_fd);
+        ::unlink(this->path.c_str());
+        Py_DECREF(this->rc_params);
+        this->modules.release();
+    }
+
+    /**
+     * @brief Serves clients until stop() is called, or nclients clients when nclients >= 0.
+     */
+    void run(long nclients = -1)
+    {
+        for (long n = 0; (nclients < 0 || n < nclients) && !this->stopped; ++n) {
+            int fd = ::accept4(this->listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+            if (fd < 0) {
+                if (errno == EINTR || errno == ECONNABORTED) {
+                    --n;
+                    continue;
+                }
+                if (this->stopped) {
+                    break;
+                }
+                throw std::runtime_error(std::string("accept: ") + std::strerror(errno));
+            }
+            this->serve(fd);
+            ::close(fd);
+        }
+    }
+
+    /**
+     * @brief Seconds a client may wait between requests or take to send one, 0 for no limit.
+     */
+    void set_idle_timeout(double seconds)
+    {
+        this->idle_timeout = seconds;
+    }
+
+    /**
+     * @brief Makes run() return, after the current client. Safe to call from another thread.
+     */
+    void stop()
+    {
+        this->stopped = true;
+        ::shutdown(this->listen_fd, SHUT_RDWR);
+    }
+
+private:
+    void serve(int fd)
+    {
+        if (this->idle_timeout > 0) {
+            struct timeval timeout;
+            timeout.tv_sec  = time_t(this->idle_timeout);
+            timeout.tv_usec = suseconds_t((this->idle_timeout - double(timeout.tv_sec)) * 1e6);
+            // a hung client fails recv_frame or send_frame with EAGAIN and is dropped
+            ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+            ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        }
+        std::vector<char> bytes;
+        std::vector<int> fds;
+        try {
+            while (detail::recv_frame(fd, bytes, fds)) {
+                detail::WireWriter reply;
+                this->dispatch(bytes, fds, reply);
+                for (int received : fds) {
+                    ::close(received);
+                }
+                detail::send_frame(fd, reply);
+            }
+        } catch (const std::runtime_error& e) {
+            // a broken client must not take the server down
+            std::cerr << "matplotlibcpp server: " << e.what() << std::endl;
+        }
+        this->reset();
+    }
+
+    void dispatch(const std::vector<char>& bytes, const std::vector<int>& fds, detail::WireWriter& reply)
+    {
+        try {
+            detail::WireReader reader(bytes);
+            auto target        = reader.get<std::uint64_t>();
+            std::string method = reader.get_string();
+            bool keep          = reader.get<std::uint8_t>();
+
+            detail::NewRef list   = PyList_New(0);
+            detail::NewRef kwargs = PyDict_New();
+            // every argument takes at least a keyword length and a value type
+            std::uint32_t count = reader.get<std::uint32_t>();
+            if (count > reader.remaining() / 5) {
+                throw std::runtime_error("argument count exceeds the message");
+            }
+            for (std::uint32_t n = count; n > 0; --n) {
+                std::string key = reader.get_string();
+                if (key.empty()) {
+                    detail::NewRef value = this->get_value(reader, fds);
+                    PyList_Append(list, value);
+                } else {
+                    detail::set_item(kwargs, key, this->get_value(reader, fds));
+                }
+            }
+            detail::NewRef args = PyList_AsTuple(list);
+
+            if (method == "__release__") {
+                this->release(target);
+                reply.put(std::uint8_t(1));
+                reply.put_string("");
+                reply.put_none();
+                return;
+            }
+            PyObject* object = target == 0 ? this->modules.plt : this->get_handle(target);
+            detail::NewRef func = PyObject_GetAttrString(object, method.c_str());
+            if (!func) {
+                throw std::runtime_error(detail::get_python_error());
+            }
+            detail::NewRef res = PyObject_Call(func, args, kwargs);
+            if (!res) {
+                throw std::runtime_error(method + ": " + detail::get_python_error());
+            }
+            reply.put(std::uint8_t(1));
+            reply.put_string("");
+            if (keep) {
+                Py_INCREF(res);
+                this->handles[this->next_handle] = res;
+                reply.put_handle(this->next_handle++);
+            } else {
+                this->put_value(reply, res);
+            }
+        } catch (const std::runtime_error& e) {
+            reply.bytes.clear();
+            reply.put(std::uint8_t(0));
+            reply.put_string(e.what());
+            reply.put_none();
+        }
+    }
+
+    // New reference to the python object of the next value, lists nest at most wire_max_depth deep.
+    PyObject* get_value(detail::WireReader& reader, const std::vector<int>& fds, int depth = 0)
+    {
+        switch (reader.get<std::uint8_t>()) {
+            case detail::WIRE_NONE:
+                Py_INCREF(Py_None);
+                return Py_None;
+            case detail::WIRE_BOOL:
+                return PyBool_FromLong(reader.get<std::uint8_t>());
+            case detail::WIRE_LONG:
+                return PyLong_FromLongLong(reader.get<std::int64_t>());
+            case detail::WIRE_DOUBLE:
+                return PyFloat_FromDouble(reader.get<double>());
+            case detail::WIRE_STRING: {
+                std::string s = reader.get_string();
+                return PyUnicode_FromStringAndSize(s.data(), Py_ssize_t(s.size()));
+            }
+            case detail::WIRE_ARRAY:
+                return this->get_array(reader, fds);
+            case detail::WIRE_HANDLE: {
+                PyObject* object = this->get_handle(reader.get<std::uint64_t>());
+                Py_INCREF(object);
+                return object;
+            }
+            case detail::WIRE_LIST: {
+                // every item takes at least its value type
+                std::uint32_t size = reader.get<std::uint32_t>();
+                if (size > reader.remaining()) {
+                    throw std::runtime_error("list size exceeds the message");
+                }
+                if (depth >= detail::wire_max_depth) {
+                    throw std::runtime_error("lists nested too deeply");
+                }
+                detail::NewRef list = PyList_New(Py_ssize_t(size));
+                if (!list) {
+                    throw std::runtime_error(detail::get_python_error());
+                }
+                for (Py_ssize_t i = 0; i < PyList_Size(list); ++i) {
+                    PyList_SetItem(list, i, this->get_value(reader, fds, depth + 1));
+                }
+                Py_INCREF(list);
+                return list;
+            }
+        }
+        throw std::runtime_error("unknown value type");
+    }
+
+    PyObject* get_array(detail::WireReader& reader, const std::vector<int>& fds)
+    {
+        char dtype = reader.get<char>();
+        int type   = detail::get_npy_type(dtype);
+        std::vector<npy_intp> shape(reader.get<std::uint8_t>());
+        for (auto& n : shape) {
+            n = npy_intp(reader.get<std::int64_t>());
+        }
+        auto size = reader.get<std::uint64_t>();
+        // the data must cover the array exactly, the client is not trusted
+        if (size != detail::get_array_bytes(dtype, shape)) {
+            throw std::runtime_error("array size does not match its shape and dtype");
+        }
+        if (reader.get<std::uint8_t>() == 0) {
+            // inline arrays live in the request buffer, matplotlib may keep them
+            const char* bytes = reader.get_bytes(std::size_t(size));
+            PyObject* array   = PyArray_SimpleNew(int(shape.size()), shape.data(), type);
+            if (!array) {
+                throw std::runtime_error(detail::get_python_error());
+            }
+            std::memcpy(PyArray_DATA((PyArrayObject*)array), bytes, std::size_t(size));
+            return array;
+        }
+        auto index = reader.get<std::uint32_t>();
+        if (index >= fds.size()) {
+            throw std::runtime_error("missing file descriptor of an array");
+        }
+        struct stat st;
+        if (::fstat(fds[index], &st) != 0) {
+            throw std::runtime_error(std::string("fstat: ") + std::strerror(errno));
+        }
+        if (st.st_size < 0 || std::uint64_t(st.st_size) < size) {
+            throw std::runtime_error("shared memory of an array is smaller than the array");
+        }
+        void* data = ::mmap(nullptr, std::size_t(size), PROT_READ, MAP_SHARED, fds[index], 0);
+        if (data == MAP_FAILED) {
+            throw std::runtime_error(std::string("mmap: ") + std::strerror(errno));
+        }
+        PyObject* array =
+            PyArray_New(&PyArray_Type, int(shape.size()), shape.data(), type, nullptr, data, 0, NPY_ARRAY_CARRAY_RO, nullptr);
+        if (!array) {
+            ::munmap(data, std::size_t(size));
+            throw std::runtime_error(detail::get_python_error());
+        }
+        PyObject* base = PyCapsule_New(new detail::SharedBuffer{data, std::size_t(size)}, "matplotlibcpp.SharedBuffer",
+                                       detail::SharedBuffer::release);
+        // steals base, the mapping lives as long as the array
+        PyArray_SetBaseObject((PyArrayObject*)array, base);
+        return array;
+    }
+
+    // Scalars, strings and sequences of them are sent back, other objects as None.
+    void put_value(detail::WireWriter& writer, PyObject* value)
+    {
+        if (PyBool_Check(value)) {
+            writer.put_value(value == Py_True);
+        } else if (PyLong_Check(value)) {
+            int overflow = 0;
+            long number  = PyLong_AsLongAndOverflow(value, &overflow);
+            if (overflow) {
+                // too large for the wire, sent as a double
+                double approx = PyLong_AsDouble(value);
+                PyErr_Clear();
+                writer.put_value(approx);
+            } else {
+                writer.put_value(number);
+            }
+        } else if (PyFloat_Check(value)) {
+            writer.put_value(PyFloat_AsDouble(value));
+        } else if (PyUnicode_Check(value)) {
+            writer.put_value(std::string(PyUnicode_AsUTF8(value)));
+        } else if (PyTuple_Check(value) || PyList_Check(value)) {
+            detail::NewRef items = PySequence_Fast(value, "");
+            writer.put(detail::WIRE_LIST);
+            writer.put(std::uint32_t(PySequence_Fast_GET_SIZE((PyObject*)items)));
+            for (Py_ssize_t i = 0; i < PySequence_Fast_GET_SIZE((PyObject*)items); ++i) {
+                this->put_value(writer, PySequence_Fast_GET_ITEM((PyObject*)items, i));
+            }
+        } else {
+            writer.put_none();
+        }
+    }
+
+    PyObject* get_handle(std::uint64_t handle)
+    {
+        auto it = this->handles.find(handle);
+        if (it == this->handles.end()) {
+            throw std::runtime_error("unknown handle " + std::to_string(handle));
+        }
+        return it->second;
+    }
+
+    void release(std::uint64_t handle)
+    {
+        auto it = this->handles.find(handle);
+        if (it != this->handles.end()) {
+            Py_DECREF(it->second);
+            this->handles.erase(it);
+        }
+    }
+
+    // Forgets everything of the last client.
+    void reset()
+    {
+        for (auto& item : this->handles) {
+            Py_DECREF(item.second);
+        }
+        this->handles.clear();
+        detail::NewRef res = PyObject_CallMethod(this->modules.plt, "close", "s", "all");
+        if (!res) {
+            PyErr_Clear();
+        }
+        // e.g. rcparams() or xkcd() of the last client
+        detail::NewRef rc_params = PyObject_GetAttrString(this->modules.matplotlib, "rcParams");
+        detail::NewRef restored  = rc_params ? PyObject_CallMethod(rc_params, "update", "O", this->rc_params) : nullptr;
+        if (!restored) {
+            PyErr_Clear();
+        }
+    }
+
+    detail::Modules modules;
+    std::string path;
+    int listen_fd;
+    std::atomic_bool stopped;
+    std::uint64_t next_handle;
+    double idle_timeout;
+    PyObject* rc_params;  // copy of the rcParams at startup
+    std::unordered_map<std::uint64_t, PyObject*> handles;
+};
+}  // namespace matplotlibcpp
+
+#endif  // !__PLT_SERVER_HPP__
@@ -0,0 +1,289 @@
+#ifndef __PLT_SIMPLIFY_HPP__
+#define __PLT_SIMPLIFY_HPP__
+
+#include <cmath>
+#include <tuple>
+#include "utility.hpp"
+
+namespace matplotlibcpp
+{
+/** Options of savefig for vector formats.
+ * Lines are first reduced to the points that are visible at the output resolution, then
+ * artists that still have more than max_points points are rasterized at the output dpi.
+ * Axes, texts and small artists stay vectors. The figure is restored after saving.
+ */
+struct VectorOptions
+{
+    explicit VectorOptions(long max_points = 20000, double tolerance = 0.5)
+        : max_points(max_points), tolerance(tolerance)
+    {
+    }
+
+    long max_points;   // 0: never rasterize
+    double tolerance;  // in pixels at the output dpi, 0: no simplification
+};
+
+namespace detail
+{
+// Distance of p to the segment [a, b].
+inline double get_segment_distance(const double* p, const double* a, const double* b)
+{
+    double dx = b[0] - a[0], dy = b[1] - a[1];
+    double length2 = dx * dx + dy * dy;
+    double t       = length2 > 0 ? std::max(0.0, std::min(1.0, ((p[0] - a[0]) * dx + (p[1] - a[1]) * dy) / length2)) : 0.0;
+    double ex = a[0] + t * dx - p[0], ey = a[1] + t * dy - p[1];
+    return std::sqrt(ex * ex + ey * ey);
+}
+
+/**
+ * @brief Douglas-Peucker on the points indices of xy (n x 2), appends the kept ones to out.
+ */
+inline void simplify_polyline(const double* xy,
+                              const std::vector<std::size_t>& indices,
+                              double tolerance,
+                              std::vector<std::size_t>& out)
+{
+    if (indices.size() <= 2) {
+        out.insert(out.end(), indices.begin(), indices.end());
+        return;
+    }
+    std::vector<char> keep(indices.size(), 0);
+    keep.front() = keep.back() = 1;
+    std::vector<std::pair<std::size_t, std::size_t>> stack{{0, indices.size() - 1}};
+    while (!stack.empty()) {
+        auto range = stack.back();
+        stack.pop_back();
+        const double* a = xy + 2 * indices[range.first];
+        const double* b = xy + 2 * indices[range.second];
+        double dmax     = 0;
+        std::size_t kmax = range.first;
+        for (std::size_t k = range.first + 1; k < range.second; ++k) {
+            double d = get_segment_distance(xy + 2 * indices[k], a, b);
+            if (d > dmax) {
+                dmax = d;
+                kmax = k;
+            }
+        }
+        if (dmax > tolerance) {
+            keep[kmax] = 1;
+            stack.push_back({range.first, kmax});
+            stack.push_back({kmax, range.second});
+        }
+    }
+    for (std::size_t k = 0; k < indices.size(); ++k) {
+        if (keep[k]) {
+            out.push_back(indices[k]);
+        }
+    }
+}
+
+/**
+ * @brief Indices of the points of a polyline in display coordinates (n x 2) that are kept at a pixel size.
+ *
+ * Runs that are monotonic in x keep the first, lowest, highest and last point of every pixel column,
+ * which draws the same pixels, then every run goes through Douglas-Peucker with tolerance.
+ * Non-finite points break the line and one of each gap is kept.
+ */
+inline std::vector<std::size_t> get_simplified(const double* xy, std::size_t n, double pixel, double tolerance)
+{
+    std::vector<std::size_t> out, run;
+    std::size_t a = 0;
+    while (a < n) {
+        if (!std::isfinite(xy[2 * a]) || !std::isfinite(xy[2 * a + 1])) {
+            out.push_back(a);
+            while (a < n && !(std::isfinite(xy[2 * a]) && std::isfinite(xy[2 * a + 1]))) {
+                ++a;
+            }
+            continue;
+        }
+        std::size_t b = a;
+        bool increasing = true, decreasing = true;
+        while (b < n && std::isfinite(xy[2 * b]) && std::isfinite(xy[2 * b + 1])) {
+            if (b > a) {
+                increasing = increasing && xy[2 * b] >= xy[2 * (b - 1)];
+                decreasing = decreasing && xy[2 * b] <= xy[2 * (b - 1)];
+            }
+            ++b;
+        }
+
+        run.clear();
+        if (increasing || decreasing) {
+            std::size_t k = a;
+            while (k < b) {
+                double column    = std::floor(xy[2 * k] / pixel);
+                std::size_t first = k, low = k, high = k;
+                for (; k < b && std::floor(xy[2 * k] / pixel) == column; ++k) {
+                    low  = xy[2 * k + 1] < xy[2 * low + 1] ? k : low;
+                    high = xy[2 * k + 1] > xy[2 * high + 1] ? k : high;
+                }
+                std::size_t column_points[4] = {first, std::min(low, high), std::max(low, high), k - 1};
+                for (auto i : column_points) {
+                    if (run.empty() || run.back() != i) {
+                        run.push_back(i);
+                    }
+                }
+            }
+        } else {
+            for (std::size_t k = a; k < b; ++k) {
+                run.push_back(k);
+            }
+        }
+        simplify_polyline(xy, run, tolerance, out);
+        a = b;
+    }
+    return out;
+}
+
+/** Prepares the artists of a figure for vector output and restores them on destruction. */
+class VectorExport
+{
+public:
+    VectorExport(PyObject* fig, const VectorOptions& options, long dpi)
+    {
+        NewRef fig_dpi = PyObject_GetAttrString(fig, "dpi");
+        // one output pixel in display units, which are pixels at the figure dpi
+        double pixel    = dpi > 0 ? PyFloat_AsDouble(fig_dpi) / dpi : 1.0;
+        NewRef axes     = PyObject_GetAttrString(fig, "axes");
+        NewRef axes_seq = PySequence_Fast(axes, "axes");
+        for (Py_ssize_t i = 0; i < PySequence_Fast_GET_SIZE((PyObject*)axes_seq); ++i) {
+            PyObject* ax = PySequence_Fast_GET_ITEM((PyObject*)axes_seq, i);
+            // apply pending autoscaling before reading transData
+            Load_func("get_xlim", ax).call();
+            Load_func("get_ylim", ax).call();
+
+            NewRef lines = PyObject_GetAttrString(ax, "lines");
+            NewRef lines_seq = PySequence_Fast(lines, "lines");
+            for (Py_ssize_t j = 0; j < PySequence_Fast_GET_SIZE((PyObject*)lines_seq); ++j) {
+                this->prepare_line(PySequence_Fast_GET_ITEM((PyObject*)lines_seq, j), options, pixel);
+            }
+            NewRef collections = PyObject_GetAttrString(ax, "collections");
+            NewRef collections_seq = PySequence_Fast(collections, "collections");
+            for (Py_ssize_t j = 0; j < PySequence_Fast_GET_SIZE((PyObject*)collections_seq); ++j) {
+                PyObject* collection = PySequence_Fast_GET_ITEM((PyObject*)collections_seq, j);
+                if (options.max_points > 0 && get_points(collection) > options.max_points) {
+                    this->rasterize(collection);
+                }
+            }
+        }
+    }
+
+    VectorExport(const VectorExport&) = delete;
+    VectorExport& operator=(const VectorExport&) = delete;
+
+    ~VectorExport()
+    {
+        try {
+            for (auto& line : this->lines) {
+                PyContainer args;
+                args << std::get<1>(line) << std::get<2>(line);
+                Load_func("set_data", std::get<0>(line)).call(args.to_tuple());
+            }
+            for (auto& artist : this->rasterized) {
+                PyContainer args;
+                args << false;
+                Load_func("set_rasterized", artist).call(args.to_tuple());
+            }
+        } catch (const std::runtime_error&) {
+            PyErr_Clear();
+        }
+    }
+
+private:
+    void prepare_line(PyObject* line, const VectorOptions& options, double pixel)
+    {
+        Load_func xydata("get_xydata", line);
+        xydata.call();
+        NewRef xy = PyArray_FROMANY(xydata.res, NPY_DOUBLE, 2, 2, NPY_ARRAY_CARRAY_RO);
+        if (!xy) {
+            PyErr_Clear();
+            return;
+        }
+        long n = long(PyArray_DIM((PyArrayObject*)(PyObject*)xy, 0));
+
+        if (options.tolerance > 0 && n > 2 && !has_markers(line)) {
+            Load_func transform("get_transform", line);
+            transform.call();
+            Load_func to_display("transform", transform.res);
+            PyContainer points;
+            points << xy;
+            to_display.call(points.to_tuple());
+            NewRef display = PyArray_FROMANY(to_display.res, NPY_DOUBLE, 2, 2, NPY_ARRAY_CARRAY_RO);
+            auto kept      = get_simplified((const double*)PyArray_DATA((PyArrayObject*)(PyObject*)display), std::size_t(n),
+                                            pixel, options.tolerance * pixel);
+            if (long(kept.size()) < n) {
+                const double* data = (const double*)PyArray_DATA((PyArrayObject*)(PyObject*)xy);
+                std::vector<double> x(kept.size()), y(kept.size());
+                for (std::size_t k = 0; k < kept.size(); ++k) {
+                    x[k] = data[2 * kept[k]];
+                    y[k] = data[2 * kept[k] + 1];
+                }
+                Load_func xorig("get_xdata", line), yorig("get_ydata", line);
+                xorig.call();
+                yorig.call();
+                this->lines.emplace_back(BorrowedRef(line), BorrowedRef(xorig.res), BorrowedRef(yorig.res));
+
+                PyContainer args;
+                args << get_pyarray(x) << get_pyarray(y);
+                Load_func("set_data", line).call(args.to_tuple());
+                n = long(kept.size());
+            }
+        }
+        if (options.max_points > 0 && n > options.max_points) {
+            this->rasterize(line);
+        }
+    }
+
+    // Lines with markers or steps are drawn point by point and are not simplified.
+    static bool has_markers(PyObject* line)
+    {
+        Load_func marker("get_marker", line), linestyle("get_linestyle", line), drawstyle("get_drawstyle", line);
+        marker.call();
+        linestyle.call();
+        drawstyle.call();
+        auto is = [](PyObject* value, const char* s) {
+            return PyUnicode_Check(value) && std::string(PyUnicode_AsUTF8(value)) == s;
+        };
+        bool no_marker = marker.res == Py_None || is(marker.res, "None") || is(marker.res, "") || is(marker.res, " ");
+        return !no_marker || is(linestyle.res, "None") || !is(drawstyle.res, "default");
+    }
+
+    // Number of points of a collection: its offsets, or the vertices of its paths.
+    static long get_points(PyObject* collection)
+    {
+        Load_func offsets("get_offsets", collection);
+        offsets.call();
+        long n = long(PySequence_Size(offsets.res));
+        Load_func paths("get_paths", collection);
+        paths.call();
+        NewRef paths_seq = PySequence_Fast(paths.res, "paths");
+        if (PySequence_Fast_GET_SIZE((PyObject*)paths_seq) > 1) {
+            long vertices = 0;
+            for (Py_ssize_t k = 0; k < PySequence_Fast_GET_SIZE((PyObject*)paths_seq); ++k) {
+                NewRef v = PyObject_GetAttrString(PySequence_Fast_GET_ITEM((PyObject*)paths_seq, k), "vertices");
+                vertices += v ? long(PySequence_Size(v)) : 0;
+            }
+            n = std::max(n, vertices);
+        }
+        PyErr_Clear();
+        return n;
+    }
+
+    void rasterize(PyObject* artist)
+    {
+        Load_func rasterized("get_rasterized", artist);
+        rasterized.call();
+        if (rasterized.res != Py_True) {
+            PyContainer args;
+            args << true;
+            Load_func("set_rasterized", artist).call(args.to_tuple());
+            this->rasterized.emplace_back(artist);
+        }
+    }
+
+    std::vector<std::tuple<BorrowedRef, BorrowedRef, BorrowedRef>> lines;  // line, x, y
+    std::vector<BorrowedRef> rasterized;
+};
+}  // namespace detail
+}  // namespace matplotlibcpp
+
+#endif  // !__PLT_SIMPLIFY_HPP__
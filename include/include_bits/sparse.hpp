@@ -0,0 +1,207 @@
+#ifndef __PLT_SPARSE_HPP__
+#define __PLT_SPARSE_HPP__
+
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include "utility.hpp"
+
+namespace matplotlibcpp
+{
+/** Sparse matrix in CSR form, row i holds the columns indices[indptr[i]] to indices[indptr[i + 1] - 1].
+ * The arrays are not copied, values is optional.
+ */
+template <typename Index = long, typename Scalar = double>
+struct CsrMatrix
+{
+    CsrMatrix(const Index* indptr, const Index* indices, long nrows, long ncols, const Scalar* values = nullptr)
+        : indptr(indptr), indices(indices), values(values), nrows(nrows), ncols(ncols)
+    {
+    }
+
+    const Index* indptr;
+    const Index* indices;
+    const Scalar* values;
+    long nrows;
+    long ncols;
+};
+
+/** Sparse matrix in COO form, entry k is at rows[k], cols[k]. The arrays are not copied, values is optional. */
+template <typename Index = long, typename Scalar = double>
+struct CooMatrix
+{
+    CooMatrix(const Index* rows,
+              const Index* cols,
+              std::size_t nnz,
+              long nrows,
+              long ncols,
+              const Scalar* values = nullptr)
+        : rows(rows), cols(cols), values(values), nnz(nnz), nrows(nrows), ncols(ncols)
+    {
+    }
+
+    const Index* rows;
+    const Index* cols;
+    const Scalar* values;
+    std::size_t nnz;
+    long nrows;
+    long ncols;
+};
+
+/** Options of spy on sparse matrices.
+ * The marker mode plots one marker per nonzero, the image mode shows the number
+ * of nonzeros per pixel, which stays cheap for any number of nonzeros.
+ */
+struct SpyOptions
+{
+    explicit SpyOptions(bool image = false, double precision = 0, double markersize = 0, unsigned nthreads = 0)
+        : image(image), precision(precision), markersize(markersize), nthreads(nthreads)
+    {
+    }
+
+    bool image;         // density image instead of markers
+    double precision;   // entries with |value| <= precision are zeros
+    double markersize;  // 0: matplotlib's default
+    unsigned nthreads;  // 0: std::thread::hardware_concurrency()
+};
+
+namespace detail
+{
+template <typename Scalar>
+bool is_nonzero(const Scalar* values, std::size_t k, double precision)
+{
+    return !values || std::abs(double(values[k])) > precision;
+}
+
+/**
+ * @brief Nonzero coordinates of the matrix, as column and row arrays.
+ */
+template <typename Index, typename Scalar>
+std::pair<std::vector<double>, std::vector<double>> get_nonzeros(const CsrMatrix<Index, Scalar>& m, double precision)
+{
+    std::pair<std::vector<double>, std::vector<double>> nonzeros;
+    for (long i = 0; i < m.nrows; ++i) {
+        for (std::int64_t k = m.indptr[i]; k < std::int64_t(m.indptr[i + 1]); ++k) {
+            if (is_nonzero(m.values, std::size_t(k), precision)) {
+                nonzeros.first.push_back(double(m.indices[k]));
+                nonzeros.second.push_back(double(i));
+            }
+        }
+    }
+    return nonzeros;
+}
+
+template <typename Index, typename Scalar>
+std::pair<std::vector<double>, std::vector<double>> get_nonzeros(const CooMatrix<Index, Scalar>& m, double precision)
+{
+    std::pair<std::vector<double>, std::vector<double>> nonzeros;
+    for (std::size_t k = 0; k < m.nnz; ++k) {
+        if (is_nonzero(m.values, k, precision)) {
+            nonzeros.first.push_back(double(m.cols[k]));
+            nonzeros.second.push_back(double(m.rows[k]));
+        }
+    }
+    return nonzeros;
+}
+
+/**
+ * @brief Throws if an index of the matrix is out of range or indptr decreases.
+ */
+template <typename Index, typename Scalar>
+void check_matrix(const CsrMatrix<Index, Scalar>& m)
+{
+    if (m.nrows < 0 || m.ncols < 0 || (m.nrows > 0 && (!m.indptr || std::int64_t(m.indptr[0]) < 0))) {
+        throw std::runtime_error("CsrMatrix: invalid shape or indptr");
+    }
+    for (long i = 0; i < m.nrows; ++i) {
+        if (std::int64_t(m.indptr[i + 1]) < std::int64_t(m.indptr[i])) {
+            throw std::runtime_error("CsrMatrix: indptr decreases at row " + std::to_string(i));
+        }
+    }
+    std::int64_t nnz = m.nrows > 0 ? std::int64_t(m.indptr[m.nrows]) - std::int64_t(m.indptr[0]) : 0;
+    const Index* indices = m.nrows > 0 ? m.indices + m.indptr[0] : m.indices;
+    for (std::int64_t k = 0; k < nnz; ++k) {
+        if (std::int64_t(indices[k]) < 0 || std::int64_t(indices[k]) >= m.ncols) {
+            throw std::runtime_error("CsrMatrix: column index out of range: " + std::to_string(std::int64_t(indices[k])));
+        }
+    }
+}
+
+template <typename Index, typename Scalar>
+void check_matrix(const CooMatrix<Index, Scalar>& m)
+{
+    if (m.nrows < 0 || m.ncols < 0) {
+        throw std::runtime_error("CooMatrix: invalid shape");
+    }
+    for (std::size_t k = 0; k < m.nnz; ++k) {
+        if (std::int64_t(m.rows[k]) < 0 || std::int64_t(m.rows[k]) >= m.nrows || std::int64_t(m.cols[k]) < 0 ||
+            std::int64_t(m.cols[k]) >= m.ncols) {
+            throw std::runtime_error("CooMatrix: entry " + std::to_string(k) + " out of range");
+        }
+    }
+}
+
+/**
+ * @brief Number of nonzeros per pixel of a w x h image of the matrix, row-major from the first row.
+ *
+ * Pixel row r gathers the matrix rows i with i * h / nrows == r, so every task
+ * owns one pixel row and the rows are processed in parallel without locking.
+ */
+template <typename Index, typename Scalar>
+void get_density(const CsrMatrix<Index, Scalar>& m, long w, long h, double precision, unsigned nthreads, float* out)
+{
+    std::fill(out, out + w * h, 0.0f);
+    parallel_for(std::size_t(h), nthreads, [&](std::size_t r) {
+        long begin = long((std::int64_t(r) * m.nrows + h - 1) / h);
+        long end   = long((std::int64_t(r + 1) * m.nrows + h - 1) / h);
+        float* row = out + r * w;
+        for (long i = begin; i < end; ++i) {
+            for (std::int64_t k = m.indptr[i]; k < std::int64_t(m.indptr[i + 1]); ++k) {
+                if (is_nonzero(m.values, std::size_t(k), precision)) {
+                    row[std::int64_t(m.indices[k]) * w / m.ncols] += 1.0f;
+                }
+            }
+        }
+    });
+}
+
+/**
+ * @brief Density image of a COO matrix, the entries are split between threads with private images.
+ *
+ * The first task counts into out, the private images of the others take at most 32 MB in total,
+ * so a large image is shared by fewer threads rather than copied once per thread.
+ */
+template <typename Index, typename Scalar>
+void get_density(const CooMatrix<Index, Scalar>& m, long w, long h, double precision, unsigned nthreads, float* out)
+{
+    if (nthreads == 0) {
+        nthreads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    std::size_t pixels     = std::size_t(w) * std::size_t(h);
+    std::size_t max_images = (std::size_t(32) << 20) / (pixels * sizeof(float) + 1);
+    std::size_t ntasks     = std::min<std::size_t>({nthreads, m.nnz / 65536 + 1, max_images + 1});
+    std::vector<std::vector<float>> images(ntasks - 1, std::vector<float>(pixels, 0.0f));
+    std::fill(out, out + pixels, 0.0f);
+    parallel_for(ntasks, nthreads, [&](std::size_t t) {
+        float* image = t == 0 ? out : images[t - 1].data();
+        for (std::size_t k = m.nnz * t / ntasks; k < m.nnz * (t + 1) / ntasks; ++k) {
+            if (is_nonzero(m.values, k, precision)) {
+                image[std::int64_t(m.rows[k]) * h / m.nrows * w + std::int64_t(m.cols[k]) * w / m.ncols] += 1.0f;
+            }
+        }
+    });
+    if (images.empty()) {
+        return;
+    }
+    parallel_for(std::size_t(h), nthreads, [&](std::size_t r) {
+        for (const auto& image : images) {
+            for (long j = 0; j < w; ++j) {
+                out[r * w + j] += image[r * w + j];
+            }
+        }
+    });
+}
+}  // namespace detail
+}  // namespace matplotlibcpp
+
+#endif  // !__PLT_SPARSE_HPP__
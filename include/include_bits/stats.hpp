@@ -0,0 +1,221 @@
+#ifndef __PLT_STATS_HPP__
+#define __PLT_STATS_HPP__
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include "utility.hpp"
+
+namespace matplotlibcpp
+{
+namespace detail
+{
+/** Statistics of one box, with the keys of matplotlib.cbook.boxplot_stats. */
+struct BoxStats
+{
+    double mean, med, q1, q3, iqr, cilo, cihi, whislo, whishi;
+    std::vector<double> fliers;
+};
+
+/** Statistics of one violin, the density is estimated at points coords. */
+struct ViolinStats
+{
+    double mean, median, min, max;
+    std::vector<double> coords, vals;
+};
+
+/**
+ * @brief Linearly interpolated quantiles like numpy.percentile, ps must be increasing.
+ *
+ * values is partially reordered by nth_element, every quantile only looks at the part
+ * above the previous one.
+ */
+inline std::vector<double> get_quantiles(std::vector<double>& values, const std::vector<double>& ps)
+{
+    std::vector<double> quantiles;
+    auto begin = values.begin();
+    for (double p : ps) {
+        double h = (values.size() - 1) * p;
+        auto lo  = values.begin() + std::ptrdiff_t(std::floor(h));
+        std::nth_element(begin, lo, values.end());
+        double a = *lo, b = lo + 1 < values.end() ? *std::min_element(lo + 1, values.end()) : a;
+        quantiles.push_back(a + (h - std::floor(h)) * (b - a));
+        begin = lo;
+    }
+    return quantiles;
+}
+
+// The finite values of data.
+template <typename Scalar>
+std::vector<double> get_finite(const std::vector<Scalar>& data)
+{
+    std::vector<double> values;
+    values.reserve(data.size());
+    for (const auto& value : data) {
+        if (std::isfinite(double(value))) {
+            values.push_back(double(value));
+        }
+    }
+    return values;
+}
+
+/**
+ * @brief Box statistics of data, whis is {factor} or {low percentile, high percentile} like
+ * matplotlib's whis=1.5 or whis=(5, 95). Whiskers reach the furthest values within factor * IQR
+ * of the box, or within the percentiles.
+ *
+ * The notch interval is med +/- 1.57 IQR / sqrt(n).
+ */
+template <typename Scalar>
+BoxStats get_box_stats(const std::vector<Scalar>& data, const std::vector<double>& whis)
+{
+    assert(whis.size() == 1 || whis.size() == 2);
+    BoxStats stats;
+    auto values = get_finite(data);
+    if (values.empty()) {
+        stats.mean = stats.med = stats.q1 = stats.q3 = stats.iqr = NAN;
+        stats.cilo = stats.cihi = stats.whislo = stats.whishi = NAN;
+        return stats;
+    }
+    std::vector<double> ps = {0.25, 0.5, 0.75};
+    if (whis.size() == 2) {
+        ps.push_back(whis[0] / 100);
+        ps.push_back(whis[1] / 100);
+        std::sort(ps.begin(), ps.end());
+    }
+    auto quantiles = get_quantiles(values, ps);
+    auto quantile  = [&](double p) { return quantiles[std::lower_bound(ps.begin(), ps.end(), p) - ps.begin()]; };
+    stats.q1       = quantile(0.25);
+    stats.med      = quantile(0.5);
+    stats.q3       = quantile(0.75);
+    stats.iqr      = stats.q3 - stats.q1;
+    stats.cilo     = stats.med - 1.57 * stats.iqr / std::sqrt(double(values.size()));
+    stats.cihi     = stats.med + 1.57 * stats.iqr / std::sqrt(double(values.size()));
+
+    double low  = whis.size() == 2 ? quantile(whis[0] / 100) : stats.q1 - whis[0] * stats.iqr;
+    double high = whis.size() == 2 ? quantile(whis[1] / 100) : stats.q3 + whis[0] * stats.iqr;
+    double sum = 0;
+    stats.whislo = INFINITY;
+    stats.whishi = -INFINITY;
+    for (double value : values) {
+        sum += value;
+        if (value >= low) {
+            stats.whislo = std::min(stats.whislo, value);
+        }
+        if (value <= high) {
+            stats.whishi = std::max(stats.whishi, value);
+        }
+    }
+    stats.mean   = sum / values.size();
+    stats.whislo = std::isfinite(stats.whislo) ? std::min(stats.whislo, stats.q1) : stats.q1;
+    stats.whishi = std::isfinite(stats.whishi) ? std::max(stats.whishi, stats.q3) : stats.q3;
+    for (double value : values) {
+        if (value < stats.whislo || value > stats.whishi) {
+            stats.fliers.push_back(value);
+        }
+    }
+    return stats;
+}
+
+/**
+ * @brief Box statistics of data, whiskers reach the furthest values within whis * IQR of the box.
+ */
+template <typename Scalar>
+BoxStats get_box_stats(const std::vector<Scalar>& data, double whis = 1.5)
+{
+    return get_box_stats(data, std::vector<double>{whis});
+}
+
+/**
+ * @brief Violin statistics of data with a Gaussian KDE evaluated at npoints points between min and max.
+ *
+ * The bandwidth follows Scott's rule like scipy's gaussian_kde. The samples are first
+ * binned on a fine grid, so the cost is linear in the number of samples.
+ */
+template <typename Scalar>
+ViolinStats get_violin_stats(const std::vector<Scalar>& data, long npoints = 100)
+{
+    ViolinStats stats;
+    auto values = get_finite(data);
+    if (values.empty()) {
+        stats.mean = stats.median = stats.min = stats.max = NAN;
+        return stats;
+    }
+    auto range = std::minmax_element(values.begin(), values.end());
+    stats.min  = *range.first;
+    stats.max  = *range.second;
+
+    double n = double(values.size()), sum = 0, sum2 = 0;
+    for (double value : values) {
+        sum += value;
+    }
+    stats.mean = sum / n;
+    for (double value : values) {
+        sum2 += (value - stats.mean) * (value - stats.mean);
+    }
+    double sigma     = values.size() > 1 ? std::sqrt(sum2 / (n - 1)) : 0.0;
+    double bandwidth = std::pow(n, -0.2) * sigma;
+
+    const long nbins = 1024;
+    double width     = (stats.max - stats.min) / nbins;
+    std::vector<double> counts(nbins, 0.0);
+    for (double value : values) {
+        long bin = width > 0 ? std::min(nbins - 1, long((value - stats.min) / width)) : 0;
+        counts[bin] += 1;
+    }
+    stats.median = get_quantiles(values, {0.5})[0];
+
+    stats.coords.resize(npoints);
+    stats.vals.resize(npoints);
+    for (long k = 0; k < npoints; ++k) {
+        double coord    = npoints > 1 ? stats.min + (stats.max - stats.min) * k / (npoints - 1) : stats.min;
+        stats.coords[k] = coord;
+        if (bandwidth <= 0) {
+            stats.vals[k] = coord == stats.mean ? 1.0 : 0.0;
+            continue;
+        }
+        double density = 0;
+        for (long b = 0; b < nbins; ++b) {
+            if (counts[b] > 0) {
+                double u = (coord - (stats.min + (b + 0.5) * width)) / bandwidth;
+                density += counts[b] * std::exp(-0.5 * u * u);
+            }
+        }
+        stats.vals[k] = density / (n * bandwidth * std::sqrt(2 * M_PI));
+    }
+    return stats;
+}
+
+/** bxp statistics as a python dict. */
+inline NewRef get_pydict(const BoxStats& stats, const std::string& label)
+{
+    PyObject* dict = PyDict_New();
+    const std::pair<const char*, double> items[] = {
+        {"mean", stats.mean}, {"med", stats.med},   {"q1", stats.q1},         {"q3", stats.q3},        {"iqr", stats.iqr},
+        {"cilo", stats.cilo}, {"cihi", stats.cihi}, {"whislo", stats.whislo}, {"whishi", stats.whishi}};
+    for (const auto& item : items) {
+        set_item(dict, item.first, PyFloat_FromDouble(item.second));
+    }
+    PyDict_SetItemString(dict, "fliers", get_pyarray(stats.fliers));
+    if (!label.empty()) {
+        set_item(dict, "label", PyUnicode_FromString(label.c_str()));
+    }
+    return dict;
+}
+
+/** violin statistics as a python dict. */
+inline NewRef get_pydict(const ViolinStats& stats)
+{
+    PyObject* dict = PyDict_New();
+    set_item(dict, "mean", PyFloat_FromDouble(stats.mean));
+    set_item(dict, "median", PyFloat_FromDouble(stats.median));
+    set_item(dict, "min", PyFloat_FromDouble(stats.min));
+    set_item(dict, "max", PyFloat_FromDouble(stats.max));
+    PyDict_SetItemString(dict, "coords", get_pyarray(stats.coords));
+    PyDict_SetItemString(dict, "vals", get_pyarray(stats.vals));
+    return dict;
+}
+}  // namespace detail
+}  // namespace matplotlibcpp
+
+#endif  // !__PLT_STATS_HPP__
@@ -0,0 +1,125 @@
+#ifndef __PLT_TEXT_HPP__
+#define __PLT_TEXT_HPP__
+
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include "utility.hpp"
+
+namespace matplotlibcpp
+{
+/** Per-label style of texts.
+ * Empty vectors fall back to the keywords, otherwise they have one entry per label
+ * (two for offsets, four for colors).
+ */
+struct TextStyles
+{
+    std::vector<double> offsets;  // (dx, dy) in points
+    std::vector<double> colors;   // RGBA in [0, 1], 4 per label
+    std::vector<double> sizes;    // font size in points
+};
+
+/** Options of texts.
+ * With cull, labels that would overlap an earlier label or lie outside the axes are dropped,
+ * earlier labels take precedence. Text extents are estimated from the font size and the
+ * number of characters, padding in points is added around every label.
+ */
+struct TextOptions
+{
+    explicit TextOptions(bool cull = false, double padding = 1.0) : cull(cull), padding(padding) {}
+
+    bool cull;
+    double padding;
+};
+
+namespace detail
+{
+/** Label box in display coordinates. */
+struct TextBox
+{
+    double x0, y0, x1, y1;
+
+    bool overlaps(const TextBox& other) const
+    {
+        return this->x0 < other.x1 && other.x0 < this->x1 && this->y0 < other.y1 && other.y0 < this->y1;
+    }
+};
+
+// Number of code points of an UTF-8 string.
+inline std::size_t get_length(const std::string& s)
+{
+    std::size_t n = 0;
+    for (unsigned char c : s) {
+        n += (c & 0xC0) != 0x80;
+    }
+    return n;
+}
+
+/**
+ * @brief Estimated box of a single line label anchored at (x, y), size in pixels.
+ *
+ * Glyphs are taken as 0.6 em wide, the box spans from 0.2 em below the baseline to 0.8 em above it.
+ */
+inline TextBox get_text_box(double x, double y, std::size_t length, double size, const std::string& ha, const std::string& va)
+{
+    double width = 0.6 * size * length;
+    double x0    = ha == "center" ? x - width / 2 : ha == "right" ? x - width : x;
+    double y0    = va == "bottom" ? y : va == "top" ? y - size : va == "center" ? y - size / 2 : y - 0.2 * size;
+    return {x0, y0, x0 + width, y0 + size};
+}
+
+/** Greedy overlap culling on a spatial hash.
+ * Every accepted box is stored in the grid cells it covers, a new box is only
+ * checked against the boxes of its own cells.
+ */
+class TextCuller
+{
+public:
+    explicit TextCuller(double cell) : cell(std::max(cell, 1.0)) {}
+
+    // Accepts the box if it overlaps no accepted box.
+    bool accept(const TextBox& box)
+    {
+        long i0 = this->index(box.x0), i1 = this->index(box.x1);
+        long j0 = this->index(box.y0), j1 = this->index(box.y1);
+        for (long i = i0; i <= i1; ++i) {
+            for (long j = j0; j <= j1; ++j) {
+                auto it = this->grid.find(this->key(i, j));
+                if (it == this->grid.end()) {
+                    continue;
+                }
+                for (std::size_t k : it->second) {
+                    if (this->boxes[k].overlaps(box)) {
+                        return false;
+                    }
+                }
+            }
+        }
+        for (long i = i0; i <= i1; ++i) {
+            for (long j = j0; j <= j1; ++j) {
+                this->grid[this->key(i, j)].push_back(this->boxes.size());
+            }
+        }
+        this->boxes.push_back(box);
+        return true;
+    }
+
+private:
+    long index(double v) const
+    {
+        return long(std::floor(v / this->cell));
+    }
+
+    static std::int64_t key(long i, long j)
+    {
+        return (std::int64_t(i) << 32) ^ std::int64_t(std::uint32_t(j));
+    }
+
+    double cell;
+    std::vector<TextBox> boxes;
+    std::unordered_map<std::int64_t, std::vector<std::size_t>> grid;
+};
+}  // namespace detail
+}  // namespace matplotlibcpp
+
+#endif  // !__PLT_TEXT_HPP__
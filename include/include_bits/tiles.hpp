@@ -0,0 +1,257 @@
+#ifndef __PLT_TILES_HPP__
+#define __PLT_TILES_HPP__
+
+#include "render_cache.hpp"
+
+#include <sys/wait.h>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+
+namespace matplotlibcpp
+{
+/** Options of savefig_tiles.
+ * The figure is cut into tiles of tile_size x tile_size pixels which nprocs forked processes
+ * render independently, so the memory of a process is bounded by one tile and not by the canvas.
+ */
+struct TileOptions
+{
+    explicit TileOptions(long tile_size = 4096, unsigned nprocs = 0, const std::string& format = "png")
+        : tile_size(tile_size), nprocs(nprocs), format(format)
+    {
+    }
+
+    long tile_size;      // pixels
+    unsigned nprocs;     // 0: one per core, 1: render in this process
+    std::string format;  // of the tile files
+};
+
+/** A tile written by savefig_tiles, rows and y count from the top of the figure. */
+struct Tile
+{
+    long row;
+    long col;
+    long x;
+    long y;
+    long width;
+    long height;
+    std::string filename;
+};
+
+namespace detail
+{
+/**
+ * @brief Tiles of a width x height canvas, row by row from the top left.
+ */
+inline std::vector<Tile> get_tiles(long width, long height, long tile_size, const std::string& format)
+{
+    std::vector<Tile> tiles;
+    for (long y = 0, row = 0; y < height; y += tile_size, ++row) {
+        for (long x = 0, col = 0; x < width; x += tile_size, ++col) {
+            Tile tile;
+            tile.row      = row;
+            tile.col      = col;
+            tile.x        = x;
+            tile.y        = y;
+            tile.width    = std::min(tile_size, width - x);
+            tile.height   = std::min(tile_size, height - y);
+            tile.filename = "tile_" + std::to_string(row) + "_" + std::to_string(col) + "." + format;
+            tiles.push_back(tile);
+        }
+    }
+    return tiles;
+}
+
+// Renders one tile: savefig clipped to the tile's box in inches, the canvas has the size of the tile.
+inline void render_tile(PyObject* fig, PyObject* bbox_class, const Tile& tile, long height, long dpi,
+                        const std::string& path, const std::string& format)
+{
+    // matplotlib truncates the canvas size, the box is made a fraction of a pixel larger
+    const double eps = 1e-3;
+    double x0 = double(tile.x) / dpi, x1 = (tile.x + tile.width + eps) / dpi;
+    double y0 = double(height - tile.y - tile.height) / dpi, y1 = (height - tile.y + eps) / dpi;
+    NewRef bbox = PyObject_CallMethod(bbox_class, "from_extents", "dddd", x0, y0, x1, y1);
+    if (!bbox) {
+        throw std::runtime_error("Couldn't create the box of a tile");
+    }
+    PyContainer args;
+    args << path;
+    NewRef kwargs = PyDict_New();
+    set_item(kwargs, "dpi", PyLong_FromLong(dpi));
+    set_item(kwargs, "format", PyUnicode_FromString(format.c_str()));
+    set_item(kwargs, "pad_inches", PyFloat_FromDouble(0.0));
+    PyDict_SetItemString(kwargs, "bbox_inches", bbox);
+    Load_func("savefig", fig).call(args.to_tuple(), kwargs);
+}
+
+/**
+ * @brief Replaces the layout engine of fig by engine, None to detach it.
+ *
+ * set_layout_engine("none") leaves a placeholder engine, and savefig pre-draws a figure with
+ * any engine on a renderer of the full canvas size. From matplotlib 3.6, where layout engines
+ * were introduced, the private Figure._layout_engine is set instead. Other versions fall back
+ * to the public set_layout_engine.
+ */
+inline void set_layout_engine(PyObject* fig, PyObject* engine)
+{
+    NewRef matplotlib = PyImport_ImportModule("matplotlib");
+    NewRef version    = matplotlib ? PyObject_GetAttrString(matplotlib, "__version__") : nullptr;
+    int major = 0, minor = 0;
+    if (version && PyUnicode_Check(version)) {
+        std::sscanf(PyUnicode_AsUTF8(version), "%d.%d", &major, &minor);
+    }
+    PyErr_Clear();
+    if ((major > 3 || (major == 3 && minor >= 6)) && PyObject_HasAttrString(fig, "_layout_engine")) {
+        if (PyObject_SetAttrString(fig, "_layout_engine", engine) != 0) {
+            throw std::runtime_error("Couldn't set the layout engine");
+        }
+        return;
+    }
+    PyContainer args;
+    if (engine == Py_None) {
+        args << std::string("none");
+    } else {
+        args << BorrowedRef(engine);
+    }
+    Load_func("set_layout_engine", fig).call(args.to_tuple());
+}
+
+// Number of running python threads, forking while others run may deadlock the workers.
+inline long get_python_threads()
+{
+    NewRef threading = PyImport_ImportModule("threading");
+    NewRef count     = threading ? PyObject_CallMethod(threading, "active_count", nullptr) : nullptr;
+    if (!count) {
+        PyErr_Clear();
+        return 1;
+    }
+    return PyLong_AsLong(count);
+}
+
+inline void write_tile_index(const std::string& directory,
+                             const std::vector<Tile>& tiles,
+                             long width,
+                             long height,
+                             long dpi,
+                             const TileOptions& options)
+{
+    std::ofstream out(directory + "/index.json");
+    out << "{\n  \"width\": " << width << ",\n  \"height\": " << height << ",\n  \"dpi\": " << dpi
+        << ",\n  \"tile_size\": " << options.tile_size << ",\n  \"rows\": " << (tiles.empty() ? 0 : tiles.back().row + 1)
+        << ",\n  \"cols\": " << (tiles.empty() ? 0 : tiles.back().col + 1) << ",\n  \"format\": \"" << options.format
+        << "\",\n  \"tiles\": [";
+    for (std::size_t k = 0; k < tiles.size(); ++k) {
+        const Tile& t = tiles[k];
+        out << (k ? "," : "") << "\n    {\"file\": \"" << t.filename << "\", \"row\": " << t.row << ", \"col\": " << t.col
+            << ", \"x\": " << t.x << ", \"y\": " << t.y << ", \"width\": " << t.width << ", \"height\": " << t.height
+            << "}";
+    }
+    out << "\n  ]\n}\n";
+    if (!out) {
+        throw std::runtime_error("Couldn't write " + directory + "/index.json");
+    }
+}
+
+/**
+ * @brief Renders fig at dpi as tiles in directory, with an index.json describing them.
+ *
+ * The layout engine runs once before the tiles are rendered and is detached until they are done,
+ * so every tile sees the same layout and no canvas of the full size is ever allocated. Worker
+ * processes are forked from this one and render every nprocs-th tile, a failed worker makes the
+ * call throw. Forking requires that no other thread runs: the tiles are rendered in this process
+ * while other python threads are alive, and the caller must not run C++ threads meanwhile.
+ */
+inline std::vector<Tile> savefig_tiles(PyObject* fig, const std::string& directory, long dpi, const TileOptions& options)
+{
+    if (options.tile_size <= 0 || dpi <= 0) {
+        throw std::runtime_error("savefig_tiles: tile_size and dpi must be positive");
+    }
+    make_directories(directory);
+    NewRef transforms = PyImport_ImportModule("matplotlib.transforms");
+    if (!transforms) {
+        throw std::runtime_error("Error loading module matplotlib.transforms!");
+    }
+    NewRef bbox_class = PyObject_GetAttrString(transforms, "Bbox");
+
+    Load_func get_size("get_size_inches", fig);
+    get_size.call();
+    NewRef size   = PySequence_List(get_size.res);
+    long width    = std::lround(PyFloat_AsDouble(PyList_GetItem(size, 0)) * dpi);
+    long height   = std::lround(PyFloat_AsDouble(PyList_GetItem(size, 1)) * dpi);
+    auto tiles    = get_tiles(width, height, options.tile_size, options.format);
+    unsigned nprocs = options.nprocs ? options.nprocs : std::max(std::thread::hardware_concurrency(), 1u);
+    nprocs          = unsigned(std::min<std::size_t>(nprocs, tiles.size()));
+    // a forked worker only has this thread, the locks held by the other ones are never released
+    if (get_python_threads() > 1) {
+        nprocs = 1;
+    }
+
+    Load_func get_engine("get_layout_engine", fig);
+    get_engine.call();
+    BorrowedRef engine(get_engine.res);
+    if (engine != Py_None) {
+        PyContainer args;
+        args << BorrowedRef(fig);
+        Load_func("execute", engine).call(args.to_tuple());
+    }
+    set_layout_engine(fig, Py_None);
+    auto restore = [&]() { set_layout_engine(fig, engine); };
+
+    auto render = [&](unsigned worker) {
+        for (std::size_t k = worker; k < tiles.size(); k += std::max(nprocs, 1u)) {
+            render_tile(fig, bbox_class, tiles[k], height, dpi, directory + "/" + tiles[k].filename, options.format);
+        }
+    };
+
+    try {
+        if (nprocs <= 1) {
+            render(0);
+        } else {
+            std::fflush(nullptr);
+            std::vector<pid_t> workers;
+            for (unsigned w = 0; w < nprocs; ++w) {
+                PyOS_BeforeFork();
+                pid_t pid = ::fork();
+                if (pid == 0) {
+                    PyOS_AfterFork_Child();
+                    int status = 0;
+                    try {
+                        render(w);
+                    } catch (const std::exception& e) {
+                        PyErr_Print();
+                        std::fprintf(stderr, "savefig_tiles: %s\n", e.what());
+                        status = 1;
+                    }
+                    std::fflush(nullptr);
+                    ::_exit(status);
+                }
+                PyOS_AfterFork_Parent();
+                if (pid < 0) {
+                    break;
+                }
+                workers.push_back(pid);
+            }
+            int failed = workers.size() < nprocs;
+            for (pid_t pid : workers) {
+                int status = 0;
+                pid_t done;
+                while ((done = ::waitpid(pid, &status, 0)) < 0 && errno == EINTR) {
+                }
+                failed += done < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+            }
+            if (failed) {
+                throw std::runtime_error("savefig_tiles: " + std::to_string(failed) + " worker(s) failed");
+            }
+        }
+    } catch (...) {
+        restore();
+        throw;
+    }
+    restore();
+    write_tile_index(directory, tiles, width, height, dpi, options);
+    return tiles;
+}
+}  // namespace detail
+}  // namespace matplotlibcpp
+
+#endif  // !__PLT_TILES_HPP__
@@ -1,6 +1,10 @@
 #ifndef __PLT_UTILITY_HPP__
 #define __PLT_UTILITY_HPP__
 
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <thread>
 #include "modules.hpp"
 
 namespace matplotlibcpp
@@ -9,26 +13,88 @@ using KeyWords = std::map<std::string, std::string>;
 
 namespace detail
 {
+/** Observer of the calls made through Load_func, e.g. RenderCache.
+ * on_return follows the on_call of every Load_func call, also when the call failed.
+ */
+class CallHook
+{
+public:
+    virtual ~CallHook() = default;
+    virtual void on_call(PyObject* fn, PyObject* args, PyObject* kwargs) = 0;
+    virtual void on_return(PyObject* /*fn*/) {}
+};
+
+inline std::vector<CallHook*>& get_call_hooks()
+{
+    static std::vector<CallHook*> hooks;
+    return hooks;
+}
+
+inline void add_call_hook(CallHook* hook)
+{
+    get_call_hooks().push_back(hook);
+}
+
+inline void remove_call_hook(CallHook* hook)
+{
+    auto& hooks = get_call_hooks();
+    hooks.erase(std::remove(hooks.begin(), hooks.end(), hook), hooks.end());
+}
+
+/** Reports a call to the hooks, for calls that change a figure without Load_func. */
+inline void notify_call(PyObject* fn, PyObject* args, PyObject* kwargs)
+{
+    for (auto hook : get_call_hooks()) {
+        hook->on_call(fn, args, kwargs);
+    }
+}
+
+/** Reports the end of a call to the hooks, a pending python error is kept aside meanwhile. */
+inline void notify_return(PyObject* fn)
+{
+    auto& hooks = get_call_hooks();
+    if (hooks.empty()) {
+        return;
+    }
+    PyObject *type, *value, *traceback;
+    PyErr_Fetch(&type, &value, &traceback);
+    for (auto hook : hooks) {
+        hook->on_return(fn);
+    }
+    PyErr_Restore(type, value, traceback);
+}
+
 class Load_func
 {
 public:
-    Load_func(std::string fname, PyObject* module)
+    Load_func(std::string fname, PyObject* module) : res(nullptr)
     {
         this->fn = PyObject_GetAttrString(module, fname.c_str());
         if (!fn)
             throw std::runtime_error(std::string("Couldn't find required function: ") + fname);
     }
 
+    // fn and res are owned, a copy would release them twice.
+    Load_func(const Load_func&) = delete;
+    Load_func& operator=(const Load_func&) = delete;
+    Load_func(Load_func&& other) : fn(other.fn), res(other.res)
+    {
+        other.fn  = nullptr;
+        other.res = nullptr;
+    }
+
     ~Load_func()
     {
-        Py_DECREF(this->fn);
+        Py_XDECREF(this->fn);
         this->decref_res();
     }
 
     void call(PyObject* args = nullptr, PyObject* kwargs = nullptr)
     {
+        this->decref_res();
+        notify_call(this->fn, args, kwargs);
         if (kwargs == nullptr) {
-            this->res = this->res = PyObject_CallObject(this->fn, args);
+            this->res = PyObject_CallObject(this->fn, args);
         } else {
             if (args == nullptr) {
                 PyObject* empty_tuple = PyTuple_New(0);
@@ -38,15 +104,15 @@ public:
                 this->res = PyObject_Call(this->fn, args, kwargs);
             }
         }
+        notify_return(this->fn);
         if (!this->res)
             throw std::runtime_error("Call failed.");
     }
 
     void decref_res()
     {
-        if (this->res) {
-            Py_DECREF(this->res);
-        }
+        Py_XDECREF(this->res);
+        this->res = nullptr;
     }
 
     void incref_res()
@@ -58,14 +124,150 @@ public:
     PyObject* res;
 };
 
+/** dict[key] = value, for a new reference value.
+ * PyDict_SetItemString does not steal the value, the reference is released here.
+ */
+inline void set_item(PyObject* dict, const std::string& key, PyObject* value)
+{
+    PyDict_SetItemString(dict, key.c_str(), value);
+    Py_XDECREF(value);
+}
+
+/** Runs task(0) to task(n - 1) on at most nthreads threads, 0 for std::thread::hardware_concurrency().
+ * Thread t runs the tasks t, t + nthreads, ...
+ */
+template <typename Task>
+void parallel_for(std::size_t n, unsigned nthreads, Task task)
+{
+    if (nthreads == 0) {
+        nthreads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    std::size_t nworkers = std::min<std::size_t>(nthreads, n);
+    if (nworkers <= 1) {
+        for (std::size_t k = 0; k < n; ++k) {
+            task(k);
+        }
+        return;
+    }
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < nworkers; ++t) {
+        threads.emplace_back([=, &task]() {
+            for (std::size_t k = t; k < n; k += nworkers) {
+                task(k);
+            }
+        });
+    }
+    for (auto& th : threads) {
+        th.join();
+    }
+}
+
+/**
+ * @brief The helper module that applies a method to several axes in one call, borrowed.
+ *
+ * apply(axes, name, args, kwargs) calls getattr(ax, name)(*args, **kwargs) for every ax,
+ * apply_each(axes, name, args_list, kwargs) passes the k-th args to the k-th ax. The module is
+ * defined once per interpreter.
+ */
+inline PyObject* get_grid_helpers()
+{
+    // borrowed, created empty on the first use
+    PyObject* module = PyImport_AddModule("_matplotlibcpp");
+    if (!module) {
+        throw std::runtime_error("Couldn't create module _matplotlibcpp");
+    }
+    if (!PyObject_HasAttrString(module, "apply_each")) {
+        static const char* code =
+            "def apply(axes, name, args, kwargs):\n"
+            "    args, kwargs = args or (), kwargs or {}\n"
+            "    for ax in axes:\n"
+            "        getattr(ax, name)(*args, **kwargs)\n"
+            "def apply_each(axes, name, args_list, kwargs):\n"
+            "    kwargs = kwargs or {}\n"
+            "    for ax, args in zip(axes, args_list):\n"
+            "        getattr(ax, name)(*args, **kwargs)\n";
+        PyObject* globals = PyModule_GetDict(module);
+        if (!PyDict_GetItemString(globals, "__builtins__")) {
+            PyDict_SetItemString(globals, "__builtins__", PyEval_GetBuiltins());
+        }
+        NewRef res = PyRun_String(code, Py_file_input, globals, globals);
+        if (!res) {
+            throw std::runtime_error("Couldn't define the grid helpers");
+        }
+    }
+    return module;
+}
+
 inline NewRef get_keywords(const KeyWords& keywords)
 {
     PyObject* kwargs = PyDict_New();
     for (auto it = keywords.begin(); it != keywords.end(); ++it) {
-        PyDict_SetItemString(kwargs, it->first.c_str(), PyUnicode_FromString(it->second.c_str()));
+        set_item(kwargs, it->first, PyUnicode_FromString(it->second.c_str()));
+    }
+    return kwargs;
+}
+
+/** "True", "true" and "1" are true. */
+inline bool to_bool(const std::string& value)
+{
+    return value == "True" || value == "true" || value == "1";
+}
+
+/** The numbers of a value like "1.5", "(5, 95)" or "[1, 2, 3]", throws if it holds anything else. */
+inline std::vector<double> to_numbers(const std::string& value)
+{
+    std::string s = value;
+    for (char& c : s) {
+        if (c == '(' || c == ')' || c == '[' || c == ']' || c == ',') {
+            c = ' ';
+        }
+    }
+    std::vector<double> numbers;
+    const char* p = s.c_str();
+    while (true) {
+        while (std::isspace((unsigned char)*p)) {
+            ++p;
+        }
+        if (!*p) {
+            break;
+        }
+        char* end;
+        numbers.push_back(std::strtod(p, &end));
+        if (end == p) {
+            throw std::runtime_error("Not a number or a list of numbers: " + value);
+        }
+        p = end;
+    }
+    if (numbers.empty()) {
+        throw std::runtime_error("Not a number or a list of numbers: " + value);
+    }
+    return numbers;
+}
+
+/** get_keywords, with the values of bool_keys converted by to_bool. */
+inline NewRef get_keywords(const KeyWords& keywords, const std::vector<std::string>& bool_keys)
+{
+    NewRef kwargs = get_keywords(keywords);
+    for (const auto& key : bool_keys) {
+        auto it = keywords.find(key);
+        if (it != keywords.end()) {
+            set_item(kwargs, key, PyBool_FromLong(to_bool(it->second)));
+        }
     }
     return kwargs;
 }
+
+/** Removes key from keywords and returns its value, or value if there was none. */
+inline std::string pop_keyword(KeyWords& keywords, const std::string& key, const std::string& value = "")
+{
+    auto it = keywords.find(key);
+    if (it == keywords.end()) {
+        return value;
+    }
+    std::string result = it->second;
+    keywords.erase(it);
+    return result;
+}
 }  // namespace detail
 
 }  // namespace matplotlibcpp
@@ -0,0 +1,7 @@
+#ifndef _MATPLOTLIBCPP_CLIENT_HPP_
+#define _MATPLOTLIBCPP_CLIENT_HPP_
+
+// Client of the plot server, it does not need Python to build or run.
+#include "include_bits/client.hpp"
+
+#endif  // !_MATPLOTLIBCPP_CLIENT_HPP_
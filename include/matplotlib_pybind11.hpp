@@ -0,0 +1,121 @@
+#ifndef _MATPLOTLIBCPP_PYBIND11_HPP_
+#define _MATPLOTLIBCPP_PYBIND11_HPP_
+
+// PLT for applications that embed Python with pybind11, it needs pybind11 and numpy headers.
+#include <pybind11/embed.h>
+#include <pybind11/numpy.h>
+#include "include_bits/plt.hpp"
+
+namespace matplotlibcpp
+{
+/**
+ * @brief The array data of a pybind11 object, e.g. a py::array_t or py::buffer, for the ArrayHandle overloads.
+ */
+inline ArrayHandle as_array(const pybind11::handle& object)
+{
+    return ArrayHandle(object.ptr());
+}
+
+/** PLT on the interpreter of the application, e.g. started by a py::scoped_interpreter, which
+ * is neither initialized nor finalized here. Calls must be made with the GIL held, as for any
+ * pybind11 call. pybind11 arrays and buffers are passed to matplotlib without conversion by
+ * plot, scatter, imshow, hist, bar, barh, stem, fill_between, errorbar and contour, the whole
+ * C++ API stays available for the rest. The Axes methods of the same names take as_array(object).
+ */
+struct PybindPLT : public PLT
+{
+    explicit PybindPLT(const std::string& backend = "") : PLT(check_interpreter(backend), false) {}
+
+    using PLT::bar;
+    using PLT::barh;
+    using PLT::contour;
+    using PLT::errorbar;
+    using PLT::fill_between;
+    using PLT::hist;
+    using PLT::imshow;
+    using PLT::plot;
+    using PLT::scatter;
+    using PLT::stem;
+
+    void plot(const pybind11::handle& x,
+              const pybind11::handle& y,
+              const std::string& format = "",
+              const KeyWords& keywords  = {})
+    {
+        PLT::plot(as_array(x), as_array(y), format, keywords);
+    }
+
+    void plot(const pybind11::handle& y, const std::string& format = "", const KeyWords& keywords = {})
+    {
+        PLT::plot(as_array(y), format, keywords);
+    }
+
+    void scatter(const pybind11::handle& x, const pybind11::handle& y, double s = 1.0, const KeyWords& keywords = {})
+    {
+        PLT::scatter(as_array(x), as_array(y), s, keywords);
+    }
+
+    detail::Image imshow(const pybind11::handle& data,
+                         double vmin              = NAN,
+                         double vmax              = NAN,
+                         const KeyWords& keywords = {})
+    {
+        return PLT::imshow(as_array(data), vmin, vmax, keywords);
+    }
+
+    void hist(const pybind11::handle& y, long bins = 10, const KeyWords& keywords = {})
+    {
+        PLT::hist(as_array(y), bins, keywords);
+    }
+
+    void bar(const pybind11::handle& x, const pybind11::handle& height, const KeyWords& keywords = {})
+    {
+        PLT::bar(as_array(x), as_array(height), keywords);
+    }
+
+    void barh(const pybind11::handle& y, const pybind11::handle& width, const KeyWords& keywords = {})
+    {
+        PLT::barh(as_array(y), as_array(width), keywords);
+    }
+
+    void stem(const pybind11::handle& x, const pybind11::handle& y, const KeyWords& keywords = {})
+    {
+        PLT::stem(as_array(x), as_array(y), keywords);
+    }
+
+    void fill_between(const pybind11::handle& x,
+                      const pybind11::handle& y1,
+                      const pybind11::handle& y2,
+                      const KeyWords& keywords = {})
+    {
+        PLT::fill_between(as_array(x), as_array(y1), as_array(y2), keywords);
+    }
+
+    void errorbar(const pybind11::handle& x,
+                  const pybind11::handle& y,
+                  const pybind11::handle& yerr,
+                  const KeyWords& keywords = {})
+    {
+        PLT::errorbar(as_array(x), as_array(y), as_array(yerr), keywords);
+    }
+
+    detail::Artist contour(const pybind11::handle& x,
+                           const pybind11::handle& y,
+                           const pybind11::handle& z,
+                           const KeyWords& keywords = {})
+    {
+        return PLT::contour(as_array(x), as_array(y), as_array(z), keywords);
+    }
+
+private:
+    static const std::string& check_interpreter(const std::string& backend)
+    {
+        if (!Py_IsInitialized()) {
+            throw std::runtime_error("PybindPLT: the python interpreter is not running");
+        }
+        return backend;
+    }
+};
+}  // namespace matplotlibcpp
+
+#endif  // !_MATPLOTLIBCPP_PYBIND11_HPP_
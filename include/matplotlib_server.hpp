@@ -0,0 +1,6 @@
+#ifndef _MATPLOTLIBCPP_SERVER_HPP_
+#define _MATPLOTLIBCPP_SERVER_HPP_
+
+#include "include_bits/server.hpp"
+
+#endif  // !_MATPLOTLIBCPP_SERVER_HPP_